@@ -0,0 +1,316 @@
+/*
+ * AsyncRenderer.cpp
+ */
+
+#include <unordered_set>
+#include <stdint.h>
+#include "AsyncRenderer.h"
+
+AsyncRenderer::AsyncRenderer(GraphRenderer *renderer):
+		renderer(renderer), queue(QUEUE_CAPACITY), sleeping(false), stopping(false), failed(false),
+		pushed(0), applied(0), coalesced(0) {
+	worker = thread(&AsyncRenderer::run, this);
+}
+
+/**
+ * Applies the commands still queued, then deletes the wrapped renderer.
+ */
+AsyncRenderer::~AsyncRenderer(){
+	stop();
+	delete renderer;
+}
+
+/**
+ * Applies the commands still queued and stops the I/O thread. The wrapped
+ * renderer is returned to the caller, who owns it from then on, and the
+ * AsyncRenderer must not be used any more.
+ */
+GraphRenderer* AsyncRenderer::release(){
+	stop();
+	GraphRenderer *res = renderer;
+	renderer = NULL;
+	return res;
+}
+
+void AsyncRenderer::stop(){
+	if(!worker.joinable())
+		return;
+	{
+		lock_guard<mutex> lock(sleepMutex);
+		stopping = true;
+	}
+	wakeUp.notify_one();
+	worker.join();
+}
+
+void AsyncRenderer::waitIdle(){
+	unique_lock<mutex> lock(sleepMutex);
+	while(applied != pushed)
+		idle.wait(lock);
+}
+
+/**
+ * Number of setters dropped because a later one replaced them.
+ */
+size_t AsyncRenderer::getCoalesced(){
+	lock_guard<mutex> lock(sleepMutex);
+	return coalesced;
+}
+
+/**
+ * Spins while the queue is full; wakes the I/O thread if it is sleeping.
+ * The fence pairs with the one in run, so that either the I/O thread sees
+ * the new command or the caller sees that it sleeps.
+ */
+void AsyncRenderer::push(int type, int a, int b, int c, int d, const string& text){
+	Command command;
+	command.type = type;
+	command.a = a;
+	command.b = b;
+	command.c = c;
+	command.d = d;
+	command.text = text;
+	while(!queue.tryPush(std::move(command)))
+		this_thread::yield();
+	pushed++;
+	atomic_thread_fence(memory_order_seq_cst);
+	if(sleeping){
+		lock_guard<mutex> lock(sleepMutex);
+		wakeUp.notify_one();
+	}
+}
+
+/**
+ * Body of the I/O thread.
+ */
+void AsyncRenderer::run(){
+	vector<Command> batch;
+	vector<bool> skip;
+	Command command;
+	while(true){
+		while(batch.size() < MAX_BATCH && queue.tryPop(command))
+			batch.push_back(std::move(command));
+
+		if(batch.empty()){
+			unique_lock<mutex> lock(sleepMutex);
+			sleeping = true;
+			atomic_thread_fence(memory_order_seq_cst);
+			while(queue.empty() && !stopping)
+				wakeUp.wait(lock);
+			sleeping = false;
+			if(queue.empty() && stopping)
+				break;
+			continue;
+		}
+
+		applyBatch(batch, skip);
+		{
+			lock_guard<mutex> lock(sleepMutex);
+			applied += batch.size();
+		}
+		idle.notify_all();
+		batch.clear();
+	}
+}
+
+/**
+ * Walks the batch backwards remembering which properties are set later, and
+ * forgets them at every command that is not a setter.
+ */
+void AsyncRenderer::applyBatch(vector<Command>& batch, vector<bool>& skip){
+	unordered_set<uint64_t> setLater;
+	size_t dropped = 0;
+	skip.assign(batch.size(), false);
+	for(size_t i = batch.size();i-- > 0;){
+		const Command& command = batch[i];
+		if(command.type < SET_VERTEX_LABEL){
+			setLater.clear();
+			continue;
+		}
+		uint64_t key = ((uint64_t) command.type << 32) | (uint32_t) command.a;
+		if(!setLater.insert(key).second){
+			skip[i] = true;
+			dropped++;
+		}
+	}
+
+	for(size_t i = 0;i < batch.size();i++)
+		if(!skip[i] && !apply(batch[i]))
+			failed = true;
+
+	if(dropped > 0){
+		lock_guard<mutex> lock(sleepMutex);
+		coalesced += dropped;
+	}
+}
+
+bool AsyncRenderer::apply(const Command& c){
+	switch(c.type){
+	case CREATE_WINDOW: return renderer->createWindow(c.a, c.b);
+	case CLOSE_WINDOW: return renderer->closeWindow();
+	case ADD_NODE: return renderer->addNode(c.a);
+	case ADD_NODE_AT: return renderer->addNode(c.a, c.b, c.c);
+	case ADD_EDGE: return renderer->addEdge(c.a, c.b, c.c, c.d);
+	case REMOVE_NODE: return renderer->removeNode(c.a);
+	case REMOVE_EDGE: return renderer->removeEdge(c.a);
+	case DEFINE_EDGE_CURVED: return renderer->defineEdgeCurved(c.a);
+	case DEFINE_EDGE_COLOR: return renderer->defineEdgeColor(c.text);
+	case DEFINE_EDGE_DASHED: return renderer->defineEdgeDashed(c.a);
+	case DEFINE_VERTEX_COLOR: return renderer->defineVertexColor(c.text);
+	case DEFINE_VERTEX_SIZE: return renderer->defineVertexSize(c.a);
+	case DEFINE_VERTEX_ICON: return renderer->defineVertexIcon(c.text);
+	case SET_BACKGROUND: return renderer->setBackground(c.text);
+	case REARRANGE: return renderer->rearrange();
+	case SET_BATCHING: renderer->setBatching(c.a, c.b); return true;
+	case FLUSH: return renderer->flush();
+	case SET_VERTEX_LABEL: return renderer->setVertexLabel(c.a, c.text);
+	case SET_EDGE_LABEL: return renderer->setEdgeLabel(c.a, c.text);
+	case SET_EDGE_COLOR: return renderer->setEdgeColor(c.a, c.text);
+	case SET_EDGE_DASHED: return renderer->setEdgeDashed(c.a, c.b);
+	case SET_VERTEX_COLOR: return renderer->setVertexColor(c.a, c.text);
+	case SET_VERTEX_SIZE: return renderer->setVertexSize(c.a, c.b);
+	case SET_VERTEX_ICON: return renderer->setVertexIcon(c.a, c.text);
+	case SET_EDGE_THICKNESS: return renderer->setEdgeThickness(c.a, c.b);
+	case SET_EDGE_WEIGHT: return renderer->setEdgeWeight(c.a, c.b);
+	case SET_EDGE_FLOW: return renderer->setEdgeFlow(c.a, c.b);
+	}
+	return false;
+}
+
+bool AsyncRenderer::createWindow(int width, int height){
+	push(CREATE_WINDOW, width, height);
+	return true;
+}
+
+bool AsyncRenderer::closeWindow(){
+	push(CLOSE_WINDOW);
+	return true;
+}
+
+bool AsyncRenderer::addNode(int id, int x, int y){
+	push(ADD_NODE_AT, id, x, y);
+	return true;
+}
+
+bool AsyncRenderer::addNode(int id){
+	push(ADD_NODE, id);
+	return true;
+}
+
+bool AsyncRenderer::addEdge(int id, int v1, int v2, int edgeType){
+	push(ADD_EDGE, id, v1, v2, edgeType);
+	return true;
+}
+
+bool AsyncRenderer::removeNode(int id){
+	push(REMOVE_NODE, id);
+	return true;
+}
+
+bool AsyncRenderer::removeEdge(int id){
+	push(REMOVE_EDGE, id);
+	return true;
+}
+
+bool AsyncRenderer::setVertexLabel(int id, string label){
+	push(SET_VERTEX_LABEL, id, 0, 0, 0, label);
+	return true;
+}
+
+bool AsyncRenderer::setEdgeLabel(int id, string label){
+	push(SET_EDGE_LABEL, id, 0, 0, 0, label);
+	return true;
+}
+
+bool AsyncRenderer::setEdgeColor(int id, string color){
+	push(SET_EDGE_COLOR, id, 0, 0, 0, color);
+	return true;
+}
+
+bool AsyncRenderer::setEdgeDashed(int id, bool dashed){
+	push(SET_EDGE_DASHED, id, dashed);
+	return true;
+}
+
+bool AsyncRenderer::setVertexColor(int id, string color){
+	push(SET_VERTEX_COLOR, id, 0, 0, 0, color);
+	return true;
+}
+
+bool AsyncRenderer::setVertexSize(int id, int size){
+	push(SET_VERTEX_SIZE, id, size);
+	return true;
+}
+
+bool AsyncRenderer::setVertexIcon(int id, string filepath){
+	push(SET_VERTEX_ICON, id, 0, 0, 0, filepath);
+	return true;
+}
+
+bool AsyncRenderer::setEdgeThickness(int id, int thickness){
+	push(SET_EDGE_THICKNESS, id, thickness);
+	return true;
+}
+
+bool AsyncRenderer::setEdgeWeight(int id, int weight){
+	push(SET_EDGE_WEIGHT, id, weight);
+	return true;
+}
+
+bool AsyncRenderer::setEdgeFlow(int id, int flow){
+	push(SET_EDGE_FLOW, id, flow);
+	return true;
+}
+
+bool AsyncRenderer::defineEdgeCurved(bool curved){
+	push(DEFINE_EDGE_CURVED, curved);
+	return true;
+}
+
+bool AsyncRenderer::defineEdgeColor(string color){
+	push(DEFINE_EDGE_COLOR, 0, 0, 0, 0, color);
+	return true;
+}
+
+bool AsyncRenderer::defineEdgeDashed(bool dashed){
+	push(DEFINE_EDGE_DASHED, dashed);
+	return true;
+}
+
+bool AsyncRenderer::defineVertexColor(string color){
+	push(DEFINE_VERTEX_COLOR, 0, 0, 0, 0, color);
+	return true;
+}
+
+bool AsyncRenderer::defineVertexSize(int size){
+	push(DEFINE_VERTEX_SIZE, size);
+	return true;
+}
+
+bool AsyncRenderer::defineVertexIcon(string filepath){
+	push(DEFINE_VERTEX_ICON, 0, 0, 0, 0, filepath);
+	return true;
+}
+
+bool AsyncRenderer::setBackground(string path){
+	push(SET_BACKGROUND, 0, 0, 0, 0, path);
+	return true;
+}
+
+bool AsyncRenderer::rearrange(){
+	push(REARRANGE);
+	return true;
+}
+
+void AsyncRenderer::setBatching(bool batching, bool fireAndForget){
+	push(SET_BATCHING, batching, fireAndForget);
+}
+
+/**
+ * Queues a flush of the wrapped renderer without waiting for it. False if a
+ * command failed since the last call.
+ */
+bool AsyncRenderer::flush(){
+	push(FLUSH);
+	return !failed.exchange(false);
+}
@@ -0,0 +1,121 @@
+/*
+ * AsyncRenderer.h
+ */
+
+#ifndef SRC_ASYNCRENDERER_H_
+#define SRC_ASYNCRENDERER_H_
+
+#include <vector>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include "GraphRenderer.h"
+#include "SpscQueue.h"
+
+using namespace std;
+
+/**
+ * Decorator that runs another renderer on its own I/O thread. The calling
+ * thread only pushes the commands onto a lock-free queue and returns at once,
+ * so it never waits for the viewer unless the queue is full.
+ *
+ * The I/O thread takes the commands in batches and, within a batch, drops a
+ * setter (colour, size, label, ...) when a later one sets the same property of
+ * the same node or edge, as long as no node or edge is added or removed and
+ * no default is defined in between.
+ *
+ * Commands always report success; a failure of the wrapped renderer is
+ * reported by the next flush(), which itself does not wait. waitIdle() waits
+ * until every command pushed so far has been applied.
+ * Only one thread may call the renderer.
+ */
+class AsyncRenderer: public GraphRenderer {
+
+public:
+	static const size_t QUEUE_CAPACITY = 1 << 16;
+	static const size_t MAX_BATCH = 4096;
+
+private:
+	enum CommandType {
+		CREATE_WINDOW, CLOSE_WINDOW, ADD_NODE, ADD_NODE_AT, ADD_EDGE, REMOVE_NODE, REMOVE_EDGE,
+		DEFINE_EDGE_CURVED, DEFINE_EDGE_COLOR, DEFINE_EDGE_DASHED, DEFINE_VERTEX_COLOR,
+		DEFINE_VERTEX_SIZE, DEFINE_VERTEX_ICON, SET_BACKGROUND, REARRANGE, SET_BATCHING, FLUSH,
+		//setters of one node or edge, which may be coalesced
+		SET_VERTEX_LABEL, SET_EDGE_LABEL, SET_EDGE_COLOR, SET_EDGE_DASHED, SET_VERTEX_COLOR,
+		SET_VERTEX_SIZE, SET_VERTEX_ICON, SET_EDGE_THICKNESS, SET_EDGE_WEIGHT, SET_EDGE_FLOW
+	};
+
+	struct Command {
+		int type;
+		int a, b, c, d;
+		string text;
+	};
+
+	GraphRenderer *renderer;
+	SpscQueue<Command> queue;
+	thread worker;
+
+	mutex sleepMutex;
+	condition_variable wakeUp;
+	condition_variable idle;
+	atomic<bool> sleeping;
+	atomic<bool> stopping;
+	atomic<bool> failed;
+	size_t pushed;				//only used by the caller
+	size_t applied;				//by the I/O thread, guarded by sleepMutex
+	size_t coalesced;			//by the I/O thread, guarded by sleepMutex
+
+	void push(int type, int a = 0, int b = 0, int c = 0, int d = 0, const string& text = "");
+	void run();
+	void applyBatch(vector<Command>& batch, vector<bool>& skip);
+	bool apply(const Command& command);
+	void stop();
+
+	AsyncRenderer(const AsyncRenderer&);
+	AsyncRenderer& operator=(const AsyncRenderer&);
+
+public:
+	AsyncRenderer(GraphRenderer *renderer);
+	virtual ~AsyncRenderer();
+
+	GraphRenderer* release();
+	void waitIdle();
+	size_t getCoalesced();
+
+	bool createWindow(int width, int height);
+	bool closeWindow();
+
+	bool addNode(int id, int x, int y);
+	bool addNode(int id);
+	bool addEdge(int id, int v1, int v2, int edgeType);
+	bool removeNode(int id);
+	bool removeEdge(int id);
+
+	bool setVertexLabel(int id, string label);
+	bool setEdgeLabel(int id, string label);
+	bool setEdgeColor(int id, string color);
+	bool setEdgeDashed(int id, bool dashed);
+	bool setVertexColor(int id, string color);
+	bool setVertexSize(int id, int size);
+	bool setVertexIcon(int id, string filepath);
+	bool setEdgeThickness(int id, int thickness);
+	bool setEdgeWeight(int id, int weight);
+	bool setEdgeFlow(int id, int flow);
+
+	bool defineEdgeCurved(bool curved);
+	bool defineEdgeColor(string color);
+	bool defineEdgeDashed(bool dashed);
+	bool defineVertexColor(string color);
+	bool defineVertexSize(int size);
+	bool defineVertexIcon(string filepath);
+	bool setBackground(string path);
+
+	bool rearrange();
+
+	void setBatching(bool batching, bool fireAndForget);
+	bool flush();
+};
+
+#endif /* SRC_ASYNCRENDERER_H_ */
@@ -0,0 +1,39 @@
+/*
+ * BinaryMapFormat.h
+ */
+
+#ifndef SRC_BINARYMAPFORMAT_H_
+#define SRC_BINARYMAPFORMAT_H_
+
+#include <stdint.h>
+
+/**
+ * Binary map file, written by MapReading::writeBinaryMap and read back by
+ * MapReading::readBinaryMap. Values are in the byte order of the machine that
+ * wrote the file (little-endian on x86) and the sections come right after the
+ * header in this order:
+ *
+ *   int64  osmIdOfNode[numNodes]
+ *   double x[numNodes], y[numNodes]        projected coordinates
+ *   int32  origin[numEdges], dest[numEdges]
+ *   double weight[numEdges]
+ *   int64  idRoadOfEdge[numEdges]
+ *   uint8  twoWay[numEdges]
+ *   int64  idRoad[numRoads]
+ *   uint32 nameOffset[numRoads + 1]        offsets into the string table
+ *   uint8  roadTwoWay[numRoads]
+ *   char   strings[stringTableSize]        road names, not null-terminated
+ */
+struct BinaryMapHeader {
+	char magic[4];
+	uint32_t version;
+	uint32_t numNodes;
+	uint32_t numEdges;
+	uint32_t numRoads;
+	uint32_t stringTableSize;
+};
+
+const char BINARY_MAP_MAGIC[4] = {'C', 'S', 'M', 'B'};
+const uint32_t BINARY_MAP_VERSION = 1;
+
+#endif /* SRC_BINARYMAPFORMAT_H_ */
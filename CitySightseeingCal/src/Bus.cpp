@@ -7,6 +7,20 @@
 
 #include "Bus.h"
 
+Bus::Bus(Bus&& other): route(std::move(other.route)), pois(std::move(other.pois)),
+		tourists(std::move(other.tourists)) {}
+
+Bus& Bus::operator=(Bus&& other){
+	route = std::move(other.route);
+	pois = std::move(other.pois);
+	tourists = std::move(other.tourists);
+	return *this;
+}
+
+const Route& Bus::getRoute() const {
+	return route;
+}
+
 void Bus::addTourist(Person tourist){
 	tourists.push_back(tourist);
 }
@@ -10,18 +10,25 @@
 
 #include <string>
 #include <vector>
+#include <utility>
 #include "Person.h"
+#include "Route.h"
 
 class Bus {
 
 private:
-	std::vector<int> path;
+	Route route;
 	std::string pois;
 	std::vector<Person> tourists;
 
 public:
-	Bus(std::vector<int> path){this->path = path;};
+	Bus(Route&& route): route(std::move(route)){};
+	Bus(Bus&& other);
+	Bus& operator=(Bus&& other);
+	Bus(const Bus& other) = delete;
+	Bus& operator=(const Bus& other) = delete;
 	virtual ~Bus(){};
+	const Route& getRoute() const;
 	void addTourist(Person tourist);
 	void addPoi(std::string poi);
 	std::string getPois();
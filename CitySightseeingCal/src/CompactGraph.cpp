@@ -0,0 +1,203 @@
+/*
+ * CompactGraph.cpp
+ */
+
+#include <queue>
+#include <functional>
+#include <algorithm>
+#include "CompactGraph.h"
+#include "ThreadPool.h"
+
+CompactGraph::CompactGraph(): numVertex(0), firstArc(1, 0) {}
+
+CompactGraph::CompactGraph(int numVertex, const vector<pair<int,int> >& edges, const vector<pair<double,bool> >& properties,
+		const vector<bool>& removed):
+		numVertex(numVertex), firstArc(numVertex + 1, 0) {
+	ThreadPool& pool = ThreadPool::getDefault();
+	size_t numBlocks = 1;
+	//every block counts over all the vertices: keep the counts within V + E
+	if(edges.size() >= PARALLEL_MIN_EDGES && pool.size() > 1 && numVertex > 0)
+		numBlocks = min((size_t) pool.size(), 1 + edges.size() / numVertex);
+	size_t blockSize = (edges.size() + numBlocks - 1) / numBlocks;
+
+	//count[b*V + v]: arcs leaving v in block b, turned into the position of the next one
+	vector<int> count(numBlocks * numVertex, 0);
+	vector<future<void> > tasks;
+	for(size_t b = 0;b < numBlocks;b++){
+		size_t begin = min(edges.size(), b*blockSize), end = min(edges.size(), begin + blockSize);
+		int* c = &count[b*numVertex];
+		if(numBlocks == 1)
+			countArcs(edges, properties, removed, begin, end, c);
+		else
+			tasks.push_back(pool.submit([=, &edges, &properties, &removed](){ countArcs(edges, properties, removed, begin, end, c); }));
+	}
+	ThreadPool::waitAll(tasks);
+
+	int pos = 0;
+	for(int v = 0;v < numVertex;v++){
+		firstArc[v] = pos;
+		for(size_t b = 0;b < numBlocks;b++){
+			int c = count[b*numVertex + v];
+			count[b*numVertex + v] = pos;
+			pos += c;
+		}
+	}
+	firstArc[numVertex] = pos;
+	target.resize(pos);
+	weight.resize(pos);
+	idEdge.resize(pos);
+
+	for(size_t b = 0;b < numBlocks;b++){
+		size_t begin = min(edges.size(), b*blockSize), end = min(edges.size(), begin + blockSize);
+		int* c = &count[b*numVertex];
+		if(numBlocks == 1)
+			placeArcs(edges, properties, removed, begin, end, c);
+		else
+			tasks.push_back(pool.submit([=, &edges, &properties, &removed](){ placeArcs(edges, properties, removed, begin, end, c); }));
+	}
+	ThreadPool::waitAll(tasks);
+}
+
+void CompactGraph::countArcs(const vector<pair<int,int> >& edges, const vector<pair<double,bool> >& properties,
+		const vector<bool>& removed, size_t begin, size_t end, int* count) const {
+	for(size_t i = begin;i < end;i++){
+		if(i < removed.size() && removed[i])
+			continue;
+		count[edges[i].first]++;
+		if(properties[i].second)
+			count[edges[i].second]++;
+	}
+}
+
+void CompactGraph::placeArcs(const vector<pair<int,int> >& edges, const vector<pair<double,bool> >& properties,
+		const vector<bool>& removed, size_t begin, size_t end, int* cursor){
+	for(size_t i = begin;i < end;i++){
+		if(i < removed.size() && removed[i])
+			continue;
+		int arc = cursor[edges[i].first]++;
+		target[arc] = edges[i].second;
+		weight[arc] = properties[i].first;
+		idEdge[arc] = i;
+		if(properties[i].second){
+			arc = cursor[edges[i].second]++;
+			target[arc] = edges[i].first;
+			weight[arc] = properties[i].first;
+			idEdge[arc] = i;
+		}
+	}
+}
+
+/**
+ * Cheapest arc from origin to dest, or -1 if there is none.
+ */
+int CompactGraph::findArc(int origin, int dest) const {
+	int best = -1;
+	for(int a = firstArc[origin];a < firstArc[origin+1];a++)
+		if(target[a] == dest && (best == -1 || weight[a] < weight[best]))
+			best = a;
+	return best;
+}
+
+/**
+ * Changes the weight of the arcs that leave origin and come from the given edge.
+ */
+void CompactGraph::setEdgeWeight(int origin, int edge, double w){
+	for(int a = firstArc[origin];a < firstArc[origin+1];a++)
+		if(idEdge[a] == edge)
+			weight[a] = w;
+}
+
+void CompactGraph::dijkstraShortestPath(int source, ShortestPaths& res) const {
+	dijkstraShortestPath(vector<pair<int,double> >(1, pair<int,double>(source, 0)), res);
+	res.source = source;
+}
+
+/**
+ * Search that starts in several vertices, each one already at the given
+ * distance. The paths stop at a source, whose parent is -1; res.source is -1.
+ */
+void CompactGraph::dijkstraShortestPath(const vector<pair<int,double> >& sources, ShortestPaths& res) const {
+	typedef pair<double,int> QueueEntry;
+	res.source = -1;
+	res.dist.assign(numVertex, -1);
+	res.parent.assign(numVertex, -1);
+	res.parentArc.assign(numVertex, -1);
+
+	vector<bool> processed(numVertex, false);
+	priority_queue<QueueEntry, vector<QueueEntry>, greater<QueueEntry> > pq;
+	for(size_t i = 0;i < sources.size();i++){
+		int s = sources[i].first;
+		if(res.dist[s] < 0 || sources[i].second < res.dist[s]){
+			res.dist[s] = sources[i].second;
+			pq.push(QueueEntry(sources[i].second, s));
+		}
+	}
+
+	while(!pq.empty()){
+		int v = pq.top().second;
+		pq.pop();
+		if(processed[v])
+			continue;
+		processed[v] = true;
+
+		for(int a = firstArc[v];a < firstArc[v+1];a++){
+			int w = target[a];
+			double newDist = res.dist[v] + weight[a];
+			if(res.dist[w] < 0 || newDist < res.dist[w]){
+				res.dist[w] = newDist;
+				res.parent[w] = v;
+				res.parentArc[w] = a;
+				pq.push(QueueEntry(newDist, w));
+			}
+		}
+	}
+}
+
+/**
+ * Vertices from the source of the search to dest, empty if dest was not reached.
+ */
+vector<int> CompactGraph::getPath(const ShortestPaths& res, int dest) const {
+	vector<int> path;
+	if(res.dist[dest] < 0)
+		return path;
+	for(int v = dest;v != -1;v = res.parent[v])
+		path.push_back(v);
+	reverse(path.begin(), path.end());
+	return path;
+}
+
+/**
+ * Number of vertices of the path to dest, the source included; 0 if dest was not reached.
+ */
+int CompactGraph::getPathSize(const ShortestPaths& res, int dest) const {
+	if(res.dist[dest] < 0)
+		return 0;
+	int size = 0;
+	for(int v = dest;v != -1;v = res.parent[v])
+		size++;
+	return size;
+}
+
+/**
+ * Appends the vertices of the path after the source of the search, up to and
+ * including dest, which must have been reached.
+ */
+void CompactGraph::appendPath(const ShortestPaths& res, int dest, vector<int>& nodes) const {
+	size_t start = nodes.size();
+	for(int v = dest;res.parent[v] != -1;v = res.parent[v])
+		nodes.push_back(v);
+	reverse(nodes.begin() + start, nodes.end());
+}
+
+/**
+ * Ids of the edges from the source of the search to dest, for colouring.
+ */
+vector<int> CompactGraph::getPathEdges(const ShortestPaths& res, int dest) const {
+	vector<int> path;
+	if(res.dist[dest] < 0)
+		return path;
+	for(int v = dest;res.parentArc[v] != -1;v = res.parent[v])
+		path.push_back(idEdge[res.parentArc[v]]);
+	reverse(path.begin(), path.end());
+	return path;
+}
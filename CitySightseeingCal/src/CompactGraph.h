@@ -0,0 +1,76 @@
+/*
+ * CompactGraph.h
+ */
+
+#ifndef SRC_COMPACTGRAPH_H_
+#define SRC_COMPACTGRAPH_H_
+
+#include <vector>
+#include <climits>
+
+using namespace std;
+
+/**
+ * Result of a search on a CompactGraph. It is kept outside of the graph, so
+ * several searches can run on the same graph at the same time.
+ */
+struct ShortestPaths {
+	int source;
+	vector<double> dist;		//-1 for the vertices that were not reached
+	vector<int> parent;			//previous vertex in the path, -1 for the source
+	vector<int> parentArc;		//arc used to reach the vertex
+};
+
+/**
+ * Read-only directed graph in compressed sparse row form. The arcs leaving
+ * vertex v are firstArc[v] .. firstArc[v+1]-1, and each arc keeps the id of
+ * the edge of MapReading it comes from, so a path can be coloured in GraphViewer.
+ * A two-way edge gives two arcs with the same edge id. Edges marked in removed
+ * (see MapReading::applyDiff) give no arcs.
+ *
+ * The arrays are built by counting sort in O(V + E): the arcs of each vertex
+ * are in the order of their edges. Large inputs are split in blocks that are
+ * counted and placed in parallel, with the same result as the sequential build;
+ * each block needs V counters, so there are at most 1 + E/V blocks.
+ */
+class CompactGraph {
+
+private:
+	int numVertex;
+	vector<int> firstArc;
+	vector<int> target;
+	vector<double> weight;
+	vector<int> idEdge;
+
+	void countArcs(const vector<pair<int,int> >& edges, const vector<pair<double,bool> >& properties,
+			const vector<bool>& removed, size_t begin, size_t end, int* count) const;
+	void placeArcs(const vector<pair<int,int> >& edges, const vector<pair<double,bool> >& properties,
+			const vector<bool>& removed, size_t begin, size_t end, int* cursor);
+
+public:
+	static const size_t PARALLEL_MIN_EDGES = 1 << 16;
+
+	CompactGraph();
+	CompactGraph(int numVertex, const vector<pair<int,int> >& edges, const vector<pair<double,bool> >& properties,
+			const vector<bool>& removed = vector<bool>());
+	virtual ~CompactGraph(){};
+
+	int getNumVertex() const { return numVertex; }
+	int getNumArcs() const { return target.size(); }
+	int beginArc(int v) const { return firstArc[v]; }
+	int endArc(int v) const { return firstArc[v+1]; }
+	int getTarget(int arc) const { return target[arc]; }
+	double getWeight(int arc) const { return weight[arc]; }
+	int getIdEdge(int arc) const { return idEdge[arc]; }
+	int findArc(int origin, int dest) const;
+	void setEdgeWeight(int origin, int edge, double w);
+
+	void dijkstraShortestPath(int source, ShortestPaths& res) const;
+	void dijkstraShortestPath(const vector<pair<int,double> >& sources, ShortestPaths& res) const;
+	vector<int> getPath(const ShortestPaths& res, int dest) const;
+	int getPathSize(const ShortestPaths& res, int dest) const;
+	void appendPath(const ShortestPaths& res, int dest, vector<int>& nodes) const;
+	vector<int> getPathEdges(const ShortestPaths& res, int dest) const;
+};
+
+#endif /* SRC_COMPACTGRAPH_H_ */
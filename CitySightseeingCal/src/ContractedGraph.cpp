@@ -0,0 +1,293 @@
+/*
+ * ContractedGraph.cpp
+ */
+
+#include <algorithm>
+#include "ContractedGraph.h"
+
+/**
+ * Finds the vertices that can be contracted, then walks every arc that leaves a
+ * kept vertex along its chain until the next kept vertex. The contractible
+ * vertices that no walk reached are on cycles of their own, so one vertex of
+ * each of those cycles is kept and walked from as well.
+ */
+ContractedGraph::ContractedGraph(const CompactGraph& g, const vector<int>& protectedVertices):
+		contractedOf(g.getNumVertex(), -1), firstStep(1, 0), placeOf(2*g.getNumVertex(), -1) {
+	int V = g.getNumVertex();
+
+	//first two sources of the arcs that arrive to each vertex
+	vector<int> inDegree(V, 0);
+	vector<int> inSource(2*V, -1);
+	for(int v = 0;v < V;v++)
+		for(int a = g.beginArc(v);a < g.endArc(v);a++){
+			int w = g.getTarget(a);
+			if(inDegree[w] < 2)
+				inSource[2*w + inDegree[w]] = v;
+			inDegree[w]++;
+		}
+
+	vector<bool> contractible(V, false);
+	for(int v = 0;v < V;v++){
+		int outDegree = g.endArc(v) - g.beginArc(v);
+		if(outDegree != inDegree[v] || outDegree < 1 || outDegree > 2)
+			continue;
+		int first = g.beginArc(v);
+		if(outDegree == 1){
+			int a = inSource[2*v], b = g.getTarget(first);
+			contractible[v] = (a != b && a != v && b != v);
+		}
+		else{
+			int a = g.getTarget(first), b = g.getTarget(first + 1);
+			int s1 = inSource[2*v], s2 = inSource[2*v + 1];
+			contractible[v] = (a != b && a != v && b != v && ((s1 == a && s2 == b) || (s1 == b && s2 == a)));
+		}
+	}
+	for(size_t i = 0;i < protectedVertices.size();i++)
+		contractible[protectedVertices[i]] = false;
+
+	for(int v = 0;v < V;v++)
+		if(!contractible[v]){
+			contractedOf[v] = originalOf.size();
+			originalOf.push_back(v);
+		}
+
+	vector<pair<int,int> > edges;
+	vector<pair<double,bool> > properties;
+	int unreached = 0;
+	for(size_t c = 0;;c++){
+		if(c == originalOf.size()){
+			while(unreached < V && (!contractible[unreached] || placeOf[2*unreached] != -1))
+				unreached++;
+			if(unreached == V)
+				break;
+			contractible[unreached] = false;
+			contractedOf[unreached] = originalOf.size();
+			originalOf.push_back(unreached);
+		}
+		int u = originalOf[c];
+		for(int a = g.beginArc(u);a < g.endArc(u);a++){
+			int prev = u, arc = a;
+			double weight = 0;
+			size_t start = stepNodes.size();
+			while(true){
+				int w = g.getTarget(arc);
+				weight += g.getWeight(arc);
+				stepNodes.push_back(w);
+				stepEdges.push_back(g.getIdEdge(arc));
+				stepDist.push_back(weight);
+				if(!contractible[w] || stepNodes.size() - start > (size_t) V)
+					break;
+				arc = g.beginArc(w);
+				if(g.getTarget(arc) == prev)
+					arc++;
+				prev = w;
+			}
+			int end = stepNodes.back();
+			if(contractible[end]){
+				stepNodes.resize(start);
+				stepEdges.resize(start);
+				stepDist.resize(start);
+				continue;
+			}
+			for(size_t s = start;s + 1 < stepNodes.size();s++){
+				int* place = &placeOf[2*stepNodes[s]];
+				place[place[0] == -1 ? 0 : 1] = s;
+			}
+			//a chain back to u is kept as a loop, only to reach the vertices on it
+			edges.push_back(pair<int,int>(c, contractedOf[end]));
+			properties.push_back(pair<double,bool>(weight, false));
+			chainOrigin.push_back(c);
+			firstStep.push_back(stepNodes.size());
+		}
+	}
+	graph = CompactGraph(originalOf.size(), edges, properties);
+}
+
+/**
+ * Appends the original nodes after the origin of a contracted edge, up to and including its end.
+ * contractedEdge is the id of an arc of getGraph (CompactGraph::getIdEdge).
+ */
+void ContractedGraph::appendExpansion(int contractedEdge, vector<int>& nodes) const {
+	nodes.insert(nodes.end(), stepNodes.begin() + firstStep[contractedEdge], stepNodes.begin() + firstStep[contractedEdge + 1]);
+}
+
+/**
+ * Appends the ids of the map edges of a contracted edge, for colouring.
+ */
+void ContractedGraph::appendExpansionEdges(int contractedEdge, vector<int>& edges) const {
+	edges.insert(edges.end(), stepEdges.begin() + firstStep[contractedEdge], stepEdges.begin() + firstStep[contractedEdge + 1]);
+}
+
+int ContractedGraph::chainOfStep(int step) const {
+	return upper_bound(firstStep.begin(), firstStep.end(), step) - firstStep.begin() - 1;
+}
+
+/**
+ * Search from a vertex of the map. A contracted origin starts at the ends of
+ * its chains, at the distance left to them. res is indexed by the contracted
+ * numbering, except res.source that keeps the origin; use getDistance and
+ * appendPath to read it.
+ */
+void ContractedGraph::dijkstraShortestPath(int origin, ShortestPaths& res) const {
+	vector<pair<int,double> > sources;
+	if(isKept(origin))
+		sources.push_back(pair<int,double>(contractedOf[origin], 0));
+	else
+		for(int i = 0;i < 2;i++){
+			int p = placeOf[2*origin + i];
+			if(p != -1){
+				int last = lastStep(p);
+				sources.push_back(pair<int,double>(contractedOf[stepNodes[last]], stepDist[last] - stepDist[p]));
+			}
+		}
+	graph.dijkstraShortestPath(sources, res);
+	res.source = origin;
+}
+
+/**
+ * Shortest way from the origin of res to dest. Returns its length, or -1 if
+ * dest was not reached, and sets via to the contracted vertex where the path
+ * leaves the contracted graph and step to the step of dest in a chain that
+ * starts in via (-1 if dest is via). via is -1 if dest is the origin or comes
+ * after it in the same chain.
+ */
+double ContractedGraph::reach(const ShortestPaths& res, int dest, int& via, int& step) const {
+	via = -1;
+	step = -1;
+	if(dest == res.source)
+		return 0;
+	if(isKept(dest)){
+		via = contractedOf[dest];
+		return res.dist[via];
+	}
+	double best = -1;
+	for(int i = 0;i < 2;i++){
+		int p = placeOf[2*dest + i];
+		if(p == -1)
+			continue;
+		int chain = chainOfStep(p);
+		int c = chainOrigin[chain];
+		if(res.dist[c] >= 0 && (best < 0 || res.dist[c] + stepDist[p] < best)){
+			best = res.dist[c] + stepDist[p];
+			via = c;
+			step = p;
+		}
+		if(isKept(res.source))
+			continue;
+		for(int j = 0;j < 2;j++){
+			int q = placeOf[2*res.source + j];
+			if(q != -1 && q < p && chainOfStep(q) == chain && (best < 0 || stepDist[p] - stepDist[q] < best)){
+				best = stepDist[p] - stepDist[q];
+				via = -1;
+				step = p;
+			}
+		}
+	}
+	return best;
+}
+
+/**
+ * Step of the contracted origin of res whose chain led the search to root,
+ * a vertex without parent.
+ */
+int ContractedGraph::startPlace(const ShortestPaths& res, int root) const {
+	for(int i = 0;i < 2;i++){
+		int q = placeOf[2*res.source + i];
+		if(q == -1)
+			continue;
+		int last = lastStep(q);
+		if(contractedOf[stepNodes[last]] == root && stepDist[last] - stepDist[q] == res.dist[root])
+			return q;
+	}
+	return -1;
+}
+
+/**
+ * Length of the shortest path from the origin of res to dest, -1 if there is none.
+ */
+double ContractedGraph::getDistance(const ShortestPaths& res, int dest) const {
+	int via, step;
+	return reach(res, dest, via, step);
+}
+
+/**
+ * Step of v in the given chain, -1 if v is not in it.
+ */
+int ContractedGraph::placeIn(int v, int chain) const {
+	for(int i = 0;i < 2;i++){
+		int p = placeOf[2*v + i];
+		if(p != -1 && chainOfStep(p) == chain)
+			return p;
+	}
+	return -1;
+}
+
+/**
+ * Walks the shortest path to dest from its end, appending the nodes after the
+ * origin in reverse order if nodes is not NULL. Returns the number of those
+ * nodes, -1 if dest was not reached.
+ */
+int ContractedGraph::walkBack(const ShortestPaths& res, int dest, vector<int>* nodes) const {
+	int via, step;
+	if(reach(res, dest, via, step) < 0)
+		return -1;
+	int count = 0;
+	if(step != -1){
+		int chain = chainOfStep(step);
+		int first = via == -1 ? placeIn(res.source, chain) + 1 : firstStep[chain];
+		for(int s = step;s >= first;s--, count++)
+			if(nodes != NULL)
+				nodes->push_back(stepNodes[s]);
+	}
+	if(via == -1)
+		return count;
+
+	int v = via;
+	for(;res.parent[v] != -1;v = res.parent[v]){
+		int e = graph.getIdEdge(res.parentArc[v]);
+		for(int s = firstStep[e+1] - 1;s >= firstStep[e];s--, count++)
+			if(nodes != NULL)
+				nodes->push_back(stepNodes[s]);
+	}
+	if(!isKept(res.source)){
+		int q = startPlace(res, v);
+		for(int s = lastStep(q);s > q;s--, count++)
+			if(nodes != NULL)
+				nodes->push_back(stepNodes[s]);
+	}
+	return count;
+}
+
+/**
+ * Number of nodes of the shortest path to dest, the origin included; 0 if dest was not reached.
+ */
+int ContractedGraph::getPathSize(const ShortestPaths& res, int dest) const {
+	return walkBack(res, dest, NULL) + 1;
+}
+
+/**
+ * Appends the nodes of the shortest path after the origin of res, up to and
+ * including dest, which must have been reached.
+ */
+void ContractedGraph::appendPath(const ShortestPaths& res, int dest, vector<int>& nodes) const {
+	size_t start = nodes.size();
+	walkBack(res, dest, &nodes);
+	reverse(nodes.begin() + start, nodes.end());
+}
+
+/**
+ * Shortest path between two nodes of the map, as the full sequence of
+ * original nodes. Empty if dest can not be reached.
+ */
+vector<int> ContractedGraph::getShortestPath(int origin, int dest) const {
+	vector<int> path;
+	ShortestPaths sp;
+	dijkstraShortestPath(origin, sp);
+	int size = getPathSize(sp, dest);
+	if(size == 0)
+		return path;
+	path.reserve(size);
+	path.push_back(origin);
+	appendPath(sp, dest, path);
+	return path;
+}
@@ -0,0 +1,69 @@
+/*
+ * ContractedGraph.h
+ */
+
+#ifndef SRC_CONTRACTEDGRAPH_H_
+#define SRC_CONTRACTEDGRAPH_H_
+
+#include <vector>
+#include "CompactGraph.h"
+
+using namespace std;
+
+/**
+ * Routing graph without the shape points of the map. A vertex is contracted
+ * when it only links two other vertices, whatever the roads of its edges:
+ * either a two-way vertex a <-> v <-> b or a one-way vertex a -> v -> b.
+ * Each chain of such vertices becomes one arc between the vertices that are
+ * kept, with the sum of the weights, and remembers the nodes and edges it
+ * stands for, so paths found on the small graph expand back to full node
+ * sequences of the map and road names are still found from the edges.
+ *
+ * Vertices given as protected (POIs, stops) are always kept, but searches may
+ * also start or end in a contracted vertex: they go through the ends of its
+ * chains. A cycle made only of contractible vertices keeps one of them.
+ * The contracted graph numbers its vertices 0..getNumVertex()-1;
+ * toContracted and toOriginal convert between both numberings.
+ */
+class ContractedGraph {
+
+private:
+	CompactGraph graph;
+	vector<int> originalOf;
+	vector<int> contractedOf;
+	vector<int> firstStep;
+	vector<int> stepNodes;
+	vector<int> stepEdges;
+	vector<double> stepDist;	//from the origin of the chain to the node of the step
+	vector<int> chainOrigin;	//kept vertex where each chain starts, contracted numbering
+	vector<int> placeOf;		//steps of a contracted vertex v in at most two chains: placeOf[2*v], placeOf[2*v+1]
+
+	int chainOfStep(int step) const;
+	int lastStep(int step) const { return firstStep[chainOfStep(step) + 1] - 1; }
+	double reach(const ShortestPaths& res, int dest, int& via, int& step) const;
+	int startPlace(const ShortestPaths& res, int root) const;
+	int placeIn(int v, int chain) const;
+	int walkBack(const ShortestPaths& res, int dest, vector<int>* nodes) const;
+
+public:
+	ContractedGraph(){};
+	ContractedGraph(const CompactGraph& g, const vector<int>& protectedVertices = vector<int>());
+	virtual ~ContractedGraph(){};
+
+	const CompactGraph& getGraph() const { return graph; }
+	int getNumVertex() const { return originalOf.size(); }
+	int getNumOriginalVertex() const { return contractedOf.size(); }
+	int toContracted(int v) const { return contractedOf[v]; }
+	int toOriginal(int v) const { return originalOf[v]; }
+	bool isKept(int v) const { return contractedOf[v] != -1; }
+
+	void appendExpansion(int contractedEdge, vector<int>& nodes) const;
+	void appendExpansionEdges(int contractedEdge, vector<int>& edges) const;
+	void dijkstraShortestPath(int origin, ShortestPaths& res) const;
+	double getDistance(const ShortestPaths& res, int dest) const;
+	int getPathSize(const ShortestPaths& res, int dest) const;
+	void appendPath(const ShortestPaths& res, int dest, vector<int>& nodes) const;
+	vector<int> getShortestPath(int origin, int dest) const;
+};
+
+#endif /* SRC_CONTRACTEDGRAPH_H_ */
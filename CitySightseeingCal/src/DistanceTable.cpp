@@ -0,0 +1,81 @@
+/*
+ * DistanceTable.cpp
+ */
+
+#include <algorithm>
+#include "DistanceTable.h"
+
+/**
+ * Orders the candidates of one row by distance, keeping the POI order on ties.
+ */
+struct candidate_less_than {
+	const int* row;
+	candidate_less_than(const int* row): row(row) {}
+	bool operator()(int a, int b) const {
+		return row[a] < row[b];
+	}
+};
+
+/**
+ * Table from the k x k distances already computed, dist[i*k + j] being the
+ * distance from pois[i] to pois[j] (INT_MAX if there is no path).
+ */
+DistanceTable::DistanceTable(const vector<int>& pois, const vector<int>& dist):
+		k(pois.size()), ids(pois), dist(dist) {
+	sortCandidates();
+}
+
+void DistanceTable::sortCandidates(){
+	if(k < 2)
+		return;
+	candidates.resize(k*(k-1));
+	for(int i = 0;i < k;i++){
+		int* c = &candidates[i*(k-1)];
+		int n = 0;
+		for(int j = 0;j < k;j++)
+			if(j != i)
+				c[n++] = j;
+		stable_sort(c, c + n, candidate_less_than(&dist[i*k]));
+	}
+}
+
+bool DistanceTable::isReachable(int i, int j) const {
+	int d = getDist(i, j);
+	return d != INT_MAX;
+}
+
+/**
+ * Nearest neighbour tour that starts in the row start, visits every POI and
+ * finishes in the row end. Returns the ids of the POIs in visiting order, or
+ * an empty vector if the tour gets stuck before reaching all of them.
+ */
+vector<int> DistanceTable::getPathSalesmanProblem(int start, int end) const {
+	vector<int> res;
+	vector<bool> visited(k, false);
+	res.reserve(k);
+
+	int current = start;
+	visited[start] = true;
+	visited[end] = true;
+	res.push_back(ids[start]);
+
+	for(int step = 2;step < k;step++){
+		const int* c = getCandidates(current);
+		int next = -1;
+		for(int j = 0;j < k-1;j++)
+			if(!visited[c[j]] && isReachable(current, c[j])){
+				next = c[j];
+				break;
+			}
+		if(next == -1)
+			return vector<int>();
+		visited[next] = true;
+		res.push_back(ids[next]);
+		current = next;
+	}
+
+	if(!isReachable(current, end))
+		return vector<int>();
+	res.push_back(ids[end]);
+	return res;
+}
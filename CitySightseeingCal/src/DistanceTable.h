@@ -0,0 +1,42 @@
+/*
+ * DistanceTable.h
+ */
+
+#ifndef SRC_DISTANCETABLE_H_
+#define SRC_DISTANCETABLE_H_
+
+#include <vector>
+#include <climits>
+
+using namespace std;
+
+/**
+ * Dense k x k table with the distances between the POIs of one tour.
+ * Distances are stored row-major in a single contiguous array, and each
+ * row keeps the other POIs sorted by distance (candidate list), so the
+ * tour solvers never need to build a Graph for the POIs.
+ */
+class DistanceTable {
+
+private:
+	int k;
+	vector<int> ids;
+	vector<int> dist;
+	vector<int> candidates;
+
+	void sortCandidates();
+
+public:
+	DistanceTable(const vector<int>& pois, const vector<int>& dist);
+	virtual ~DistanceTable(){};
+
+	int size() const { return k; }
+	int getId(int i) const { return ids[i]; }
+	int getDist(int i, int j) const { return dist[i*k + j]; }
+	bool isReachable(int i, int j) const;
+	const int* getCandidates(int i) const { return &candidates[i*(k-1)]; }
+
+	vector<int> getPathSalesmanProblem(int start, int end) const;
+};
+
+#endif /* SRC_DISTANCETABLE_H_ */
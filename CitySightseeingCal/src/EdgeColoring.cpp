@@ -0,0 +1,43 @@
+/*
+ * EdgeColoring.cpp
+ */
+
+#include "EdgeColoring.h"
+
+EdgeColoring::EdgeColoring(size_t numEdges): colorOf(numEdges, 0) {
+	colors.intern("");
+}
+
+/**
+ * Sets the colour of the edges, sending only the ones that change.
+ * Returns the number of edges sent.
+ */
+int EdgeColoring::paint(GraphViewer *gv, const vector<int>& edges, const string& color){
+	uint32_t id = colors.intern(color);
+	int sent = 0;
+	for(size_t i = 0;i < edges.size();i++){
+		int e = edges[i];
+		if(e >= (int) colorOf.size())
+			colorOf.resize(e + 1, 0);
+		if(colorOf[e] == id)
+			continue;
+		colorOf[e] = id;
+		gv->setEdgeColor(e, color);
+		sent++;
+	}
+	return sent;
+}
+
+/**
+ * Last colour sent for the edge, or "" if none was.
+ */
+string EdgeColoring::getColor(int edge) const {
+	return edge < (int) colorOf.size() ? colors.get(colorOf[edge]) : "";
+}
+
+/**
+ * Forgets every colour, for when the viewer was redrawn from scratch.
+ */
+void EdgeColoring::forget(){
+	colorOf.assign(colorOf.size(), 0);
+}
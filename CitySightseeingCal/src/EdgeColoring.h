@@ -0,0 +1,37 @@
+/*
+ * EdgeColoring.h
+ */
+
+#ifndef SRC_EDGECOLORING_H_
+#define SRC_EDGECOLORING_H_
+
+#include <vector>
+#include <string>
+#include <stdint.h>
+#include "graphviewer.h"
+#include "StringPool.h"
+
+using namespace std;
+
+/**
+ * Colour of every edge as last sent to a GraphViewer. Painting a set of edges
+ * only sends the edges whose colour changes, so repainting a route, or routes
+ * that share roads, costs nothing for the edges that already have the colour.
+ * Edges never painted have no known colour.
+ */
+class EdgeColoring {
+
+private:
+	vector<uint32_t> colorOf;	//ids in colors, 0 if unknown
+	StringPool colors;
+
+public:
+	EdgeColoring(size_t numEdges = 0);
+	virtual ~EdgeColoring(){};
+
+	int paint(GraphViewer *gv, const vector<int>& edges, const string& color);
+	string getColor(int edge) const;
+	void forget();
+};
+
+#endif /* SRC_EDGECOLORING_H_ */
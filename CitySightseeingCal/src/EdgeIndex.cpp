@@ -0,0 +1,57 @@
+/*
+ * EdgeIndex.cpp
+ */
+
+#include <algorithm>
+#include "EdgeIndex.h"
+
+EdgeIndex::EdgeIndex(const vector<pair<int,int> >& edges, const vector<pair<double,bool> >& properties,
+		const vector<bool>& removed){
+	vector<pair<uint64_t,int> > entries;
+	entries.reserve(2 * edges.size());
+	for(size_t i = 0;i < edges.size();i++){
+		if(i < removed.size() && removed[i])
+			continue;
+		entries.push_back(make_pair(key(edges[i].first, edges[i].second), (int) i));
+		if(properties[i].second && edges[i].first != edges[i].second)
+			entries.push_back(make_pair(key(edges[i].second, edges[i].first), (int) i));
+	}
+	sort(entries.begin(), entries.end());
+
+	keys.resize(entries.size());
+	ids.resize(entries.size());
+	for(size_t i = 0;i < entries.size();i++){
+		keys[i] = entries[i].first;
+		ids[i] = entries[i].second;
+	}
+}
+
+/**
+ * Smallest id of an edge that goes from origin to dest, or -1 if there is none.
+ */
+int EdgeIndex::find(int origin, int dest) const {
+	vector<uint64_t>::const_iterator it = lower_bound(keys.begin(), keys.end(), key(origin, dest));
+	if(it == keys.end() || *it != key(origin, dest))
+		return -1;
+	return ids[it - keys.begin()];
+}
+
+/**
+ * Appends the ids of every edge that goes from origin to dest, parallel edges included.
+ */
+void EdgeIndex::appendEdges(int origin, int dest, vector<int>& res) const {
+	uint64_t k = key(origin, dest);
+	for(size_t i = lower_bound(keys.begin(), keys.end(), k) - keys.begin();i < keys.size() && keys[i] == k;i++)
+		res.push_back(ids[i]);
+}
+
+/**
+ * Edges between each pair of consecutive nodes of a path, in order of the path.
+ */
+vector<int> EdgeIndex::getPathEdges(const vector<int>& path) const {
+	vector<int> res;
+	res.reserve(path.size());
+	for(size_t i = 0;i + 1 < path.size();i++)
+		appendEdges(path[i], path[i + 1], res);
+	return res;
+}
@@ -0,0 +1,39 @@
+/*
+ * EdgeIndex.h
+ */
+
+#ifndef SRC_EDGEINDEX_H_
+#define SRC_EDGEINDEX_H_
+
+#include <vector>
+#include <stdint.h>
+
+using namespace std;
+
+/**
+ * Finds the map edges between two nodes. Every edge is indexed from its
+ * origin to its destination and, for two-way roads, also the other way, as a
+ * sorted array of (origin, destination) keys beside the edge ids. Removed
+ * edges are left out.
+ */
+class EdgeIndex {
+
+private:
+	vector<uint64_t> keys;
+	vector<int> ids;
+
+	static uint64_t key(int origin, int dest){ return ((uint64_t) (uint32_t) origin << 32) | (uint32_t) dest; }
+
+public:
+	EdgeIndex(){};
+	EdgeIndex(const vector<pair<int,int> >& edges, const vector<pair<double,bool> >& properties,
+			const vector<bool>& removed = vector<bool>());
+	virtual ~EdgeIndex(){};
+
+	size_t size() const { return keys.size(); }
+	int find(int origin, int dest) const;
+	void appendEdges(int origin, int dest, vector<int>& res) const;
+	vector<int> getPathEdges(const vector<int>& path) const;
+};
+
+#endif /* SRC_EDGEINDEX_H_ */
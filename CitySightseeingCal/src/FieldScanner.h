@@ -0,0 +1,170 @@
+/*
+ * FieldScanner.h
+ */
+
+#ifndef SRC_FIELDSCANNER_H_
+#define SRC_FIELDSCANNER_H_
+
+#include <cstddef>
+
+/**
+ * Scanner over a buffer of lines with fields separated by ';', as in nodes.txt,
+ * roads.txt and edges.txt. It works on the buffer in place: numbers are parsed
+ * directly from the characters and text fields are returned as [begin, end) ranges.
+ *
+ * Usage: while(sc.nextLine()){ sc.readInt(id); sc.readDouble(x); ... }
+ * A read returns false when the field is not what was expected, and the caller
+ * then ignores the rest of the line.
+ */
+class FieldScanner {
+
+private:
+	const char* pos;
+	const char* lineEnd;
+	const char* end;
+
+	static bool isDigit(char c){ return c >= '0' && c <= '9'; }
+
+	void skipSpaces(){
+		while(pos < lineEnd && (*pos == ' ' || *pos == '\t'))
+			pos++;
+	}
+
+	/**
+	 * Moves past the separator that ends the current field, if there is one.
+	 */
+	void endField(){
+		skipSpaces();
+		if(pos < lineEnd && *pos == ';')
+			pos++;
+	}
+
+public:
+	FieldScanner(const char* begin, const char* end): pos(begin), lineEnd(begin), end(end) {}
+
+	/**
+	 * Moves to the next non-empty line. Handles "\n" and "\r\n" and a last
+	 * line without newline.
+	 */
+	bool nextLine(){
+		pos = lineEnd;
+		while(pos < end){
+			if(*pos == '\n' || *pos == '\r'){
+				pos++;
+				continue;
+			}
+			lineEnd = pos;
+			while(lineEnd < end && *lineEnd != '\n' && *lineEnd != '\r')
+				lineEnd++;
+			return true;
+		}
+		lineEnd = end;
+		return false;
+	}
+
+	bool readInt(long long& value){
+		skipSpaces();
+		bool negative = false;
+		if(pos < lineEnd && (*pos == '-' || *pos == '+')){
+			negative = (*pos == '-');
+			pos++;
+		}
+		if(pos == lineEnd || !isDigit(*pos))
+			return false;
+		long long v = 0;
+		while(pos < lineEnd && isDigit(*pos))
+			v = v*10 + (*pos++ - '0');
+		value = negative ? -v : v;
+		endField();
+		return true;
+	}
+
+	bool readInt(int& value){
+		long long v;
+		if(!readInt(v))
+			return false;
+		value = (int) v;
+		return true;
+	}
+
+	/**
+	 * Decimal number with optional sign, fraction and exponent.
+	 */
+	bool readDouble(double& value){
+		static const double powersOf10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8,
+				1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+		skipSpaces();
+		bool negative = false;
+		if(pos < lineEnd && (*pos == '-' || *pos == '+')){
+			negative = (*pos == '-');
+			pos++;
+		}
+
+		unsigned long long mantissa = 0;
+		int exponent = 0;
+		int digits = 0;
+		while(pos < lineEnd && isDigit(*pos)){
+			if(mantissa < 100000000000000000ULL)
+				mantissa = mantissa*10 + (*pos - '0');
+			else
+				exponent++;
+			pos++;
+			digits++;
+		}
+		if(pos < lineEnd && *pos == '.'){
+			pos++;
+			while(pos < lineEnd && isDigit(*pos)){
+				if(mantissa < 100000000000000000ULL){
+					mantissa = mantissa*10 + (*pos - '0');
+					exponent--;
+				}
+				pos++;
+				digits++;
+			}
+		}
+		if(digits == 0)
+			return false;
+		if(pos < lineEnd && (*pos == 'e' || *pos == 'E')){
+			pos++;
+			long long e;
+			if(!readInt(e))
+				return false;
+			exponent += e;
+		}
+		else
+			endField();
+
+		double v = (double) mantissa;
+		while(exponent > 22){ v *= 1e22; exponent -= 22; }
+		while(exponent < -22){ v /= 1e22; exponent += 22; }
+		if(exponent >= 0)
+			v *= powersOf10[exponent];
+		else
+			v /= powersOf10[-exponent];
+		value = negative ? -v : v;
+		return true;
+	}
+
+	/**
+	 * Text up to the next ';' or the end of the line, without surrounding spaces.
+	 */
+	void readField(const char*& begin, const char*& fieldEnd){
+		skipSpaces();
+		begin = pos;
+		while(pos < lineEnd && *pos != ';')
+			pos++;
+		fieldEnd = pos;
+		while(fieldEnd > begin && (fieldEnd[-1] == ' ' || fieldEnd[-1] == '\t'))
+			fieldEnd--;
+		if(pos < lineEnd)
+			pos++;
+	}
+
+	void skipField(){
+		const char* b;
+		const char* e;
+		readField(b, e);
+	}
+};
+
+#endif /* SRC_FIELDSCANNER_H_ */
@@ -13,6 +13,10 @@
 #include <climits>
 #include <stack>
 #include <set>
+#include <string>
+#include <iostream>
+#include <functional>
+#include "TravelTimeProfiles.h"
 
 
 using namespace std;
@@ -34,9 +38,11 @@ template <class T>
 class Vertex {
 	T info;
 	vector<Edge<T>  > adj;
+	vector<int> adjIdEdge;		//id of the map edge of each element of adj, kept apart from the hot data
 	bool visited;
 	bool processing;
 	bool addedToHeap;
+	bool blocked;
 	int indegree;
 	int dist;
 	int low;
@@ -47,7 +53,7 @@ public:
 	Vertex(T in);
 	friend class Graph<T>;
 
-	void addEdge(Vertex<T> *dest, double w);
+	void addEdge(Vertex<T> *dest, double w, int idEdge = -1);
 	bool removeEdgeTo(Vertex<T> *d);
 
 	T getInfo() const;
@@ -75,6 +81,7 @@ bool Vertex<T>::removeEdgeTo(Vertex<T> *d) {
 	typename vector<Edge<T> >::iterator ite= adj.end();
 	while (it!=ite) {
 		if (it->dest == d) {
+			adjIdEdge.erase(adjIdEdge.begin() + (it - adj.begin()));
 			adj.erase(it);
 			return true;
 		}
@@ -88,13 +95,15 @@ template <class T>
 Vertex<T>::Vertex(T in): info(in), visited(false), processing(false), indegree(0), dist(0) {
 	path = NULL;
 	addedToHeap = false;
+	blocked = false;
 }
 
 
 template <class T>
-void Vertex<T>::addEdge(Vertex<T> *dest, double w) {
+void Vertex<T>::addEdge(Vertex<T> *dest, double w, int idEdge) {
 	Edge<T> edgeD(dest,w);
 	adj.push_back(edgeD);
+	adjIdEdge.push_back(idEdge);
 }
 
 
@@ -130,7 +139,6 @@ template <class T>
 class Edge {
 	Vertex<T> * dest;
 	double weight;
-	string roadName;
 public:
 	Edge(Vertex<T> *d, double w);
 	friend class Graph<T>;
@@ -165,11 +173,21 @@ class Graph {
 	void putInStackByPosOrder_SCC(Vertex<T>* v, stack<T>& stack);
 	void printOneComponent_SCC(Vertex<T>* v, set<T>& component);
 
+	int getVertexIndex(const T &v) const;
+
+	//contexto partilhado pelas pesquisas do getKShortestPaths
+	vector<pair<int, Vertex<T>*> > searchHeap;
+	vector<Vertex<T>*> searchTouched;
+	void resetSearch();
+	int restrictedShortestPath(Vertex<T> *s, Vertex<T> *d, const vector<Vertex<T>*> &bannedNext, vector<Vertex<T>*> &res);
+	int minEdgeWeight(Vertex<T> *s, Vertex<T> *d) const;
+
 public:
 	bool addVertex(const T &in);
-	bool addEdge(const T &sourc, const T &dest, double w);
+	bool addEdge(const T &sourc, const T &dest, double w, int idEdge = -1);
 	bool removeVertex(const T &in);
 	bool removeEdge(const T &sourc, const T &dest);
+	int removeEdgesWithId(const T &sourc, int idEdge);
 	vector<T> dfs() const;
 	vector<T> bfs(Vertex<T> *v) const;
 	int maxNewChildren(Vertex<T> *v, T &inf) const;
@@ -188,9 +206,13 @@ public:
 
 	void bellmanFordShortestPath(const T &s);
 	void dijkstraShortestPath(const T &s);
+	void timeDependentShortestPath(const T &s, int departure, const TravelTimeProfiles &profiles);
+	vector<vector<T> > getKShortestPaths(const T &origin, const T &dest, int k, vector<int> &costs);
 	void floydWarshallShortestPath();
 	int edgeCost(int i, int j);
 	vector<T> getfloydWarshallPath(const T &origin, const T &dest);
+	int getfloydWarshallPathSize(const T &origin, const T &dest) const;
+	void appendfloydWarshallPath(const T &origin, const T &dest, vector<T> &res) const;
 
 	vector<vector<T> > getWeightBetweenAllVertexs();
 	vector<T> getPathSalesmanProblem(T idStart,T idEnd);
@@ -299,7 +321,7 @@ bool Graph<T>::removeVertex(const T &in) {
 }
 
 template <class T>
-bool Graph<T>::addEdge(const T &sourc, const T &dest, double w) {
+bool Graph<T>::addEdge(const T &sourc, const T &dest, double w, int idEdge) {
 	typename vector<Vertex<T>*>::iterator it= vertexSet.begin();
 	typename vector<Vertex<T>*>::iterator ite= vertexSet.end();
 	int found=0;
@@ -313,7 +335,7 @@ bool Graph<T>::addEdge(const T &sourc, const T &dest, double w) {
 	}
 	if (found!=2) return false;
 	vD->indegree++;
-	vS->addEdge(vD,w);
+	vS->addEdge(vD,w,idEdge);
 
 	return true;
 }
@@ -339,6 +361,28 @@ bool Graph<T>::removeEdge(const T &sourc, const T &dest) {
 	return vS->removeEdgeTo(vD);
 }
 
+/**
+ * Removes the edges that leave sourc with the given edge id. Returns how many were removed.
+ */
+template <class T>
+int Graph<T>::removeEdgesWithId(const T &sourc, int idEdge) {
+	Vertex<T>* v = getVertex(sourc);
+	if(v == NULL)
+		return 0;
+	int removed = 0;
+	for(size_t i = 0;i < v->adj.size();){
+		if(v->adjIdEdge[i] == idEdge){
+			v->adj[i].dest->indegree--;
+			v->adj.erase(v->adj.begin() + i);
+			v->adjIdEdge.erase(v->adjIdEdge.begin() + i);
+			removed++;
+		}
+		else
+			i++;
+	}
+	return removed;
+}
+
 template <class T>
 bool Graph<T>::isConnected(){
 	typename vector<Vertex<T>*>::const_iterator it= vertexSet.begin();
@@ -441,7 +485,7 @@ Graph<T> Graph<T>::getReversedGraph(){
 		for(int j = 0;j < vertexSet[i]->adj.size();j++){
 			Vertex<T>* v = gr.getVertex(vertexSet[i]->info);
 			Vertex<T>* w = gr.getVertex(vertexSet[i]->adj[j].dest->info);
-			w->addEdge(v, vertexSet[i]->adj[j].weight);
+			w->addEdge(v, vertexSet[i]->adj[j].weight, vertexSet[i]->adjIdEdge[j]);
 		}
 	}
 	return gr;
@@ -673,24 +717,18 @@ vector<T> Graph<T>::topologicalOrder() {
 template<class T>
 vector<T> Graph<T>::getPath(const T &origin, const T &dest){
 
-	list<T> buffer;
+	vector<T> res;
 	Vertex<T>* v = getVertex(dest);
 
-	//cout << v->info << " ";
-	buffer.push_front(v->info);
+	res.push_back(v->info);
 	while ( v->path != NULL &&  v->path->info != origin) {
 		v = v->path;
-		buffer.push_front(v->info);
+		res.push_back(v->info);
 	}
 	if( v->path != NULL )
-		buffer.push_front(v->path->info);
+		res.push_back(v->path->info);
 
-
-	vector<T> res;
-	while( !buffer.empty() ) {
-		res.push_back( buffer.front() );
-		buffer.pop_front();
-	}
+	reverse(res.begin(), res.end());
 	return res;
 }
 
@@ -788,6 +826,207 @@ void Graph<T>::dijkstraShortestPath(const T &s){
 	}
 }
 
+/**
+ * Dijkstra over time-dependent weights. The cost of an edge is its travel time at the
+ * moment the bus enters it, so dist ends up holding the arrival time at each vertex
+ * for a bus leaving s at departure. The profiles must be FIFO (leaving later never
+ * means arriving earlier), which holds for interpolated profiles with sane slopes.
+ * Library-only for now: the tour planning does not take a departure time.
+ */
+template<class T>
+void Graph<T>::timeDependentShortestPath(const T &s, int departure, const TravelTimeProfiles &profiles){
+	for(unsigned int i = 0; i < vertexSet.size(); i++) {
+		vertexSet[i]->path = NULL;
+		vertexSet[i]->dist = INT_INFINITY;
+		vertexSet[i]->processing = false;
+	}
+
+	typedef pair<int, Vertex<T>*> HeapEntry;
+	priority_queue<HeapEntry, vector<HeapEntry>, greater<HeapEntry> > pq;
+
+	Vertex<T>* v = getVertex(s);
+	v->dist = departure;
+	pq.push(HeapEntry(v->dist, v));
+
+	while(!pq.empty()){
+		v = pq.top().second;
+		int time = pq.top().first;
+		pq.pop();
+		if(v->processing || time != v->dist)
+			continue;
+		v->processing = true;
+
+		for(unsigned int i = 0; i < v->adj.size(); i++) {
+			Edge<T>& e = v->adj[i];
+			Vertex<T>* x = e.dest;
+			//times are whole seconds: round instead of truncating every edge
+			int arrival = v->dist + (int) floor(profiles.getTravelTime(v->adjIdEdge[i], e.weight, v->dist) + 0.5);
+			if(arrival < x->dist){
+				x->dist = arrival;
+				x->path = v;
+				pq.push(HeapEntry(x->dist, x));
+			}
+		}
+	}
+}
+
+template<class T>
+int Graph<T>::minEdgeWeight(Vertex<T> *s, Vertex<T> *d) const {
+	int weight = INT_INFINITY;
+	for(size_t i = 0;i < s->adj.size();i++)
+		if(s->adj[i].dest == d && s->adj[i].weight < weight)
+			weight = s->adj[i].weight;
+	return weight;
+}
+
+/**
+ * Resets only the vertices reached by the previous restricted search.
+ */
+template<class T>
+void Graph<T>::resetSearch(){
+	for(size_t i = 0;i < searchTouched.size();i++){
+		searchTouched[i]->dist = INT_INFINITY;
+		searchTouched[i]->path = NULL;
+		searchTouched[i]->processing = false;
+	}
+	searchTouched.clear();
+	searchHeap.clear();
+}
+
+/**
+ * Dijkstra from s that stops as soon as d is settled, never enters blocked vertices
+ * and never takes an edge from s to a vertex in bannedNext. Fills res with the path
+ * and returns its cost, or INT_INFINITY if d cannot be reached.
+ */
+template<class T>
+int Graph<T>::restrictedShortestPath(Vertex<T> *s, Vertex<T> *d, const vector<Vertex<T>*> &bannedNext, vector<Vertex<T>*> &res){
+	typedef pair<int, Vertex<T>*> HeapEntry;
+	greater<HeapEntry> cmp;
+	resetSearch();
+	res.clear();
+
+	s->dist = 0;
+	searchTouched.push_back(s);
+	searchHeap.push_back(HeapEntry(0, s));
+
+	while(!searchHeap.empty()){
+		pop_heap(searchHeap.begin(), searchHeap.end(), cmp);
+		Vertex<T>* v = searchHeap.back().second;
+		int dist = searchHeap.back().first;
+		searchHeap.pop_back();
+		if(v->processing || dist != v->dist)
+			continue;
+		v->processing = true;
+		if(v == d)
+			break;
+
+		for(size_t i = 0;i < v->adj.size();i++){
+			Vertex<T>* x = v->adj[i].dest;
+			if(x->blocked || x->processing)
+				continue;
+			if(v == s && find(bannedNext.begin(), bannedNext.end(), x) != bannedNext.end())
+				continue;
+			int newDist = v->dist + v->adj[i].weight;
+			if(newDist < x->dist){
+				if(x->dist == INT_INFINITY)
+					searchTouched.push_back(x);
+				x->dist = newDist;
+				x->path = v;
+				searchHeap.push_back(HeapEntry(newDist, x));
+				push_heap(searchHeap.begin(), searchHeap.end(), cmp);
+			}
+		}
+	}
+
+	if(!d->processing)
+		return INT_INFINITY;
+	for(Vertex<T>* v = d;v != NULL;v = v->path)
+		res.push_back(v);
+	reverse(res.begin(), res.end());
+	return d->dist;
+}
+
+/**
+ * Yen's algorithm: the k shortest loopless paths from origin to dest, by increasing
+ * cost, which is stored in costs. Every spur search shares the same heap and only
+ * resets the vertices it reached, so each one costs about as much as the part of the
+ * graph it explores. Library-only: the batch mode and the server plan on the
+ * CompactGraph and offer no alternative routes.
+ */
+template<class T>
+vector<vector<T> > Graph<T>::getKShortestPaths(const T &origin, const T &dest, int k, vector<int> &costs){
+	vector<vector<T> > ans;
+	costs.clear();
+	Vertex<T>* s = getVertex(origin);
+	Vertex<T>* d = getVertex(dest);
+	if(s == NULL || d == NULL || k <= 0)
+		return ans;
+
+	for(size_t i = 0;i < vertexSet.size();i++){
+		vertexSet[i]->dist = INT_INFINITY;
+		vertexSet[i]->path = NULL;
+		vertexSet[i]->processing = false;
+		vertexSet[i]->blocked = false;
+	}
+	searchTouched.clear();
+
+	vector<vector<Vertex<T>*> > found;
+	set<pair<int, vector<Vertex<T>*> > > candidates;
+	vector<Vertex<T>*> path;
+	vector<Vertex<T>*> bannedNext;
+
+	int cost = restrictedShortestPath(s, d, bannedNext, path);
+	if(cost == INT_INFINITY){
+		resetSearch();
+		return ans;
+	}
+	found.push_back(path);
+	costs.push_back(cost);
+
+	while((int)found.size() < k){
+		const vector<Vertex<T>*> prev = found.back();
+		int rootCost = 0;
+
+		for(size_t i = 0;i + 1 < prev.size();i++){
+			Vertex<T>* spur = prev[i];
+
+			bannedNext.clear();
+			for(size_t p = 0;p < found.size();p++)
+				if(found[p].size() > i+1 && equal(prev.begin(), prev.begin() + i + 1, found[p].begin()))
+					bannedNext.push_back(found[p][i+1]);
+			for(size_t j = 0;j < i;j++)
+				prev[j]->blocked = true;
+
+			vector<Vertex<T>*> spurPath;
+			int spurCost = restrictedShortestPath(spur, d, bannedNext, spurPath);
+			if(spurCost != INT_INFINITY){
+				vector<Vertex<T>*> total(prev.begin(), prev.begin() + i);
+				total.insert(total.end(), spurPath.begin(), spurPath.end());
+				candidates.insert(make_pair(rootCost + spurCost, total));
+			}
+
+			for(size_t j = 0;j < i;j++)
+				prev[j]->blocked = false;
+			rootCost += minEdgeWeight(prev[i], prev[i+1]);
+		}
+
+		if(candidates.empty())
+			break;
+		found.push_back(candidates.begin()->second);
+		costs.push_back(candidates.begin()->first);
+		candidates.erase(candidates.begin());
+	}
+	resetSearch();
+
+	for(size_t p = 0;p < found.size();p++){
+		vector<T> infos;
+		for(size_t j = 0;j < found[p].size();j++)
+			infos.push_back(found[p][j]->info);
+		ans.push_back(infos);
+	}
+	return ans;
+}
+
 template<class T>
 int Graph<T>::edgeCost(int i, int j){
 	if(i == j)
@@ -829,27 +1068,48 @@ vector<vector<T> > Graph<T>::getWeightBetweenAllVertexs(){
 	return W;
 }
 
+template<class T>
+int Graph<T>::getVertexIndex(const T &v) const {
+	for(unsigned int i = 0; i < vertexSet.size(); i++)
+		if (vertexSet[i]->info == v) return i;
+	return -1;
+}
+
 template<class T>
 vector<T> Graph<T>::getfloydWarshallPath(const T &origin, const T &dest){
 	vector<T> ans;
-	Vertex<T>* s = getVertex(origin);
-	Vertex<T>* d = getVertex(dest);
-	int si, di;
-	for(size_t i = 0;i < vertexSet.size();i++){
-		if(vertexSet[i] == s){
-			si = i;
-		}
-		if(vertexSet[i] == d){
-			di = i;
-		}
-	}
-	ans.push_back(vertexSet[si]->info);
+	ans.reserve(getfloydWarshallPathSize(origin, dest));
+	appendfloydWarshallPath(origin, dest, ans);
+	return ans;
+}
+
+/**
+ * Number of vertices in the Floyd-Warshall path between origin and dest, both included.
+ */
+template<class T>
+int Graph<T>::getfloydWarshallPathSize(const T &origin, const T &dest) const {
+	int si = getVertexIndex(origin);
+	int di = getVertexIndex(dest);
+	int size = 1;
+	for(int ind = si;ind != di;ind = P[ind][di])
+		size++;
+	return size;
+}
+
+/**
+ * Appends the Floyd-Warshall path between origin and dest to res, without allocating
+ * when res already has enough capacity.
+ */
+template<class T>
+void Graph<T>::appendfloydWarshallPath(const T &origin, const T &dest, vector<T> &res) const {
+	int si = getVertexIndex(origin);
+	int di = getVertexIndex(dest);
+	res.push_back(vertexSet[si]->info);
 	int ind = si;
 	while(ind != di){
 		ind = P[ind][di];
-		ans.push_back(vertexSet[ind]->info);
+		res.push_back(vertexSet[ind]->info);
 	}
-	return ans;
 }
 
 
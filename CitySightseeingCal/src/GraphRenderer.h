@@ -0,0 +1,58 @@
+/*
+ * GraphRenderer.h
+ */
+
+#ifndef SRC_GRAPHRENDERER_H_
+#define SRC_GRAPHRENDERER_H_
+
+#include <string>
+
+using namespace std;
+
+/**
+ * Backend that draws the graph of a GraphViewer. Every command of GraphViewer
+ * is forwarded to one of these methods, which return false on failure.
+ *
+ * Backends may keep commands back until flush(); setBatching only matters
+ * to backends that talk to another process.
+ */
+class GraphRenderer {
+
+public:
+	virtual ~GraphRenderer(){};
+
+	virtual bool createWindow(int width, int height) = 0;
+	virtual bool closeWindow() = 0;
+
+	virtual bool addNode(int id, int x, int y) = 0;
+	virtual bool addNode(int id) = 0;
+	virtual bool addEdge(int id, int v1, int v2, int edgeType) = 0;
+	virtual bool removeNode(int id) = 0;
+	virtual bool removeEdge(int id) = 0;
+
+	virtual bool setVertexLabel(int id, string label) = 0;
+	virtual bool setEdgeLabel(int id, string label) = 0;
+	virtual bool setEdgeColor(int id, string color) = 0;
+	virtual bool setEdgeDashed(int id, bool dashed) = 0;
+	virtual bool setVertexColor(int id, string color) = 0;
+	virtual bool setVertexSize(int id, int size) = 0;
+	virtual bool setVertexIcon(int id, string filepath) = 0;
+	virtual bool setEdgeThickness(int id, int thickness) = 0;
+	virtual bool setEdgeWeight(int id, int weight) = 0;
+	virtual bool setEdgeFlow(int id, int flow) = 0;
+
+	virtual bool defineEdgeCurved(bool curved) = 0;
+	virtual bool defineEdgeColor(string color) = 0;
+	virtual bool defineEdgeDashed(bool dashed) = 0;
+	virtual bool defineVertexColor(string color) = 0;
+	virtual bool defineVertexSize(int size) = 0;
+	virtual bool defineVertexIcon(string filepath) = 0;
+	virtual bool setBackground(string path) = 0;
+
+	virtual bool rearrange() = 0;
+
+	virtual void setBatching(bool /*batching*/, bool /*fireAndForget*/){}
+	virtual bool flush(){ return true; }
+};
+
+#endif /* SRC_GRAPHRENDERER_H_ */
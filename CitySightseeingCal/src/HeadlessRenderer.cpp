@@ -0,0 +1,586 @@
+/*
+ * HeadlessRenderer.cpp
+ */
+
+#include <cstdio>
+#include <cstdarg>
+#include <cmath>
+#include <algorithm>
+#include <fstream>
+#include "HeadlessRenderer.h"
+#include "edgetype.h"
+
+static void appendf(string& out, const char* format, ...){
+	char buff[256];
+	va_list args;
+	va_start(args, format);
+	int n = vsnprintf(buff, sizeof(buff), format, args);
+	va_end(args);
+	if(n > 0)
+		out.append(buff, min(n, (int) sizeof(buff) - 1));
+}
+
+/**
+ * Appends a number without going through printf, which dominates the time
+ * to write large maps.
+ */
+static void appendInt(string& out, int value){
+	char buff[12];
+	char* end = buff + sizeof(buff);
+	char* p = end;
+	unsigned int v = value < 0 ? -(unsigned int) value : value;
+	do{
+		*--p = '0' + v % 10;
+		v /= 10;
+	}while(v != 0);
+	if(value < 0)
+		*--p = '-';
+	out.append(p, end - p);
+}
+
+/**
+ * The interned names as strings, looked up once per write.
+ */
+static vector<string> namesOf(const StringPool& pool){
+	vector<string> text(pool.size());
+	for(size_t i = 0;i < text.size();i++)
+		text[i] = pool.get(i);
+	return text;
+}
+
+static void appendXml(string& out, const string& text){
+	for(size_t i = 0;i < text.size();i++)
+		switch(text[i]){
+		case '&': out += "&amp;"; break;
+		case '<': out += "&lt;"; break;
+		case '>': out += "&gt;"; break;
+		case '"': out += "&quot;"; break;
+		default: out += text[i];
+		}
+}
+
+static void appendDot(string& out, const string& text){
+	for(size_t i = 0;i < text.size();i++){
+		if(text[i] == '"' || text[i] == '\\')
+			out += '\\';
+		out += text[i];
+	}
+}
+
+HeadlessRenderer::HeadlessRenderer(int width, int height, const string& path):
+		HeadlessRenderer(width, height, path, formatOf(path)) {}
+
+HeadlessRenderer::HeadlessRenderer(int width, int height, const string& path, Format format):
+		path(path), format(format), width(width), height(height), dirty(true),
+		vertexIcon(0), background(0), vertexSize(DEFAULT_VERTEX_SIZE), edgesDashed(false), edgesCurved(true) {
+	names.intern("");
+	vertexColor = colorOf("YELLOW");
+	edgeColor = colorOf("BLACK");
+}
+
+/**
+ * Writes what was drawn since the last flush.
+ */
+HeadlessRenderer::~HeadlessRenderer(){
+	flush();
+}
+
+/**
+ * DOT for files ending in .dot or .gv, SVG otherwise.
+ */
+HeadlessRenderer::Format HeadlessRenderer::formatOf(const string& path){
+	size_t dot = path.rfind('.');
+	string ext = dot == string::npos ? "" : path.substr(dot);
+	return (ext == ".dot" || ext == ".gv") ? DOT : SVG;
+}
+
+/**
+ * Node or edge with the given id, or NULL if there is none. With create the
+ * arrays grow to hold the id and an absent entry is returned for reuse.
+ */
+HeadlessRenderer::Node* HeadlessRenderer::node(int id, bool create){
+	if(id < 0 || (!create && (id >= (int) nodes.size() || !nodes[id].present)))
+		return NULL;
+	if(id >= (int) nodes.size())
+		nodes.resize(id + 1);
+	return &nodes[id];
+}
+
+bool HeadlessRenderer::hasNode(int id) const {
+	return id >= 0 && id < (int) nodes.size() && nodes[id].present;
+}
+
+HeadlessRenderer::Edge* HeadlessRenderer::edge(int id, bool create){
+	if(id < 0 || (!create && (id >= (int) edges.size() || !edges[id].present)))
+		return NULL;
+	if(id >= (int) edges.size())
+		edges.resize(id + 1);
+	return &edges[id];
+}
+
+/**
+ * The colour constants of graphviewer.h (DARK_GRAY, ...) as SVG and X11 names (darkgray, ...).
+ */
+uint32_t HeadlessRenderer::colorOf(const string& color){
+	string name;
+	for(size_t i = 0;i < color.size();i++)
+		if(color[i] != '_')
+			name += tolower(color[i]);
+	return names.intern(name);
+}
+
+bool HeadlessRenderer::createWindow(int /*width*/, int /*height*/){
+	return true;
+}
+
+bool HeadlessRenderer::closeWindow(){
+	return flush();
+}
+
+bool HeadlessRenderer::addNode(int id, int x, int y){
+	Node* n = node(id, true);
+	if(n == NULL)
+		return false;
+	*n = Node();
+	n->present = n->placed = true;
+	n->x = x;
+	n->y = y;
+	dirty = true;
+	return true;
+}
+
+bool HeadlessRenderer::addNode(int id){
+	Node* n = node(id, true);
+	if(n == NULL)
+		return false;
+	*n = Node();
+	n->present = true;
+	dirty = true;
+	return true;
+}
+
+bool HeadlessRenderer::addEdge(int id, int v1, int v2, int edgeType){
+	Edge* e = edge(id, true);
+	if(e == NULL)
+		return false;
+	*e = Edge();
+	e->present = true;
+	e->directed = edgeType == EdgeType::DIRECTED;
+	e->v1 = v1;
+	e->v2 = v2;
+	dirty = true;
+	return true;
+}
+
+bool HeadlessRenderer::removeNode(int id){
+	Node* n = node(id);
+	if(n == NULL)
+		return false;
+	n->present = false;
+	dirty = true;
+	return true;
+}
+
+bool HeadlessRenderer::removeEdge(int id){
+	Edge* e = edge(id);
+	if(e == NULL)
+		return false;
+	e->present = false;
+	dirty = true;
+	return true;
+}
+
+bool HeadlessRenderer::setVertexLabel(int id, string label){
+	Node* n = node(id);
+	if(n == NULL)
+		return false;
+	n->label = label;
+	dirty = true;
+	return true;
+}
+
+bool HeadlessRenderer::setEdgeLabel(int id, string label){
+	Edge* e = edge(id);
+	if(e == NULL)
+		return false;
+	e->label = label;
+	dirty = true;
+	return true;
+}
+
+bool HeadlessRenderer::setEdgeColor(int id, string color){
+	Edge* e = edge(id);
+	if(e == NULL)
+		return false;
+	e->color = colorOf(color);
+	dirty = true;
+	return true;
+}
+
+bool HeadlessRenderer::setEdgeDashed(int id, bool dashed){
+	Edge* e = edge(id);
+	if(e == NULL)
+		return false;
+	e->dashedSet = true;
+	e->dashed = dashed;
+	dirty = true;
+	return true;
+}
+
+bool HeadlessRenderer::setVertexColor(int id, string color){
+	Node* n = node(id);
+	if(n == NULL)
+		return false;
+	n->color = colorOf(color);
+	dirty = true;
+	return true;
+}
+
+bool HeadlessRenderer::setVertexSize(int id, int size){
+	Node* n = node(id);
+	if(n == NULL)
+		return false;
+	n->size = size;
+	dirty = true;
+	return true;
+}
+
+bool HeadlessRenderer::setVertexIcon(int id, string filepath){
+	Node* n = node(id);
+	if(n == NULL)
+		return false;
+	n->icon = names.intern(filepath);
+	dirty = true;
+	return true;
+}
+
+bool HeadlessRenderer::setEdgeThickness(int id, int thickness){
+	Edge* e = edge(id);
+	if(e == NULL)
+		return false;
+	e->thickness = thickness;
+	dirty = true;
+	return true;
+}
+
+bool HeadlessRenderer::setEdgeWeight(int id, int weight){
+	Edge* e = edge(id);
+	if(e == NULL)
+		return false;
+	e->weightSet = true;
+	e->weight = weight;
+	dirty = true;
+	return true;
+}
+
+bool HeadlessRenderer::setEdgeFlow(int id, int flow){
+	Edge* e = edge(id);
+	if(e == NULL)
+		return false;
+	e->flowSet = true;
+	e->flow = flow;
+	dirty = true;
+	return true;
+}
+
+bool HeadlessRenderer::defineEdgeCurved(bool curved){
+	edgesCurved = curved;
+	dirty = true;
+	return true;
+}
+
+bool HeadlessRenderer::defineEdgeColor(string color){
+	edgeColor = colorOf(color);
+	dirty = true;
+	return true;
+}
+
+bool HeadlessRenderer::defineEdgeDashed(bool dashed){
+	edgesDashed = dashed;
+	dirty = true;
+	return true;
+}
+
+bool HeadlessRenderer::defineVertexColor(string color){
+	vertexColor = colorOf(color);
+	dirty = true;
+	return true;
+}
+
+bool HeadlessRenderer::defineVertexSize(int size){
+	vertexSize = size;
+	dirty = true;
+	return true;
+}
+
+bool HeadlessRenderer::defineVertexIcon(string filepath){
+	vertexIcon = names.intern(filepath);
+	dirty = true;
+	return true;
+}
+
+bool HeadlessRenderer::setBackground(string path){
+	background = names.intern(path);
+	dirty = true;
+	return true;
+}
+
+bool HeadlessRenderer::rearrange(){
+	return true;
+}
+
+bool HeadlessRenderer::flush(){
+	if(!dirty)
+		return true;
+	dirty = !write(path);
+	return !dirty;
+}
+
+/**
+ * Position of every node: its own coordinates, or a place on a circle around
+ * the centre of the drawing for the nodes added without them.
+ */
+void HeadlessRenderer::layout(vector<pair<int,int> >& positions) const {
+	positions.resize(nodes.size());
+	int unplaced = 0;
+	for(size_t i = 0;i < nodes.size();i++)
+		if(nodes[i].present && !nodes[i].placed)
+			unplaced++;
+
+	double radius = 0.4 * min(width, height);
+	int k = 0;
+	for(size_t i = 0;i < nodes.size();i++){
+		const Node& n = nodes[i];
+		if(!n.present)
+			continue;
+		if(n.placed)
+			positions[i] = pair<int,int>(n.x, n.y);
+		else{
+			double angle = 2 * M_PI * k++ / unplaced;
+			positions[i] = pair<int,int>(width/2 + radius*cos(angle), height/2 + radius*sin(angle));
+		}
+	}
+}
+
+void HeadlessRenderer::writeSvg(ostream& os) const {
+	string out;
+	out.reserve(WRITE_CHUNK_SIZE + 4096);
+	vector<pair<int,int> > pos;
+	layout(pos);
+	vector<string> text = namesOf(names);
+
+	appendf(out, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
+	appendf(out, "<svg xmlns=\"http://www.w3.org/2000/svg\" xmlns:xlink=\"http://www.w3.org/1999/xlink\" width=\"%d\" height=\"%d\" viewBox=\"0 0 %d %d\">\n", width, height, width, height);
+	out += "<defs><marker id=\"arrow\" viewBox=\"0 0 10 10\" refX=\"10\" refY=\"5\" markerWidth=\"6\" markerHeight=\"6\" orient=\"auto\"><path d=\"M0,0L10,5L0,10z\"/></marker></defs>\n";
+	if(background != 0){
+		out += "<image width=\"100%\" height=\"100%\" preserveAspectRatio=\"none\" xlink:href=\"";
+		appendXml(out, names.get(background));
+		out += "\"/>\n";
+	}
+	else
+		out += "<rect width=\"100%\" height=\"100%\" fill=\"lightgray\"/>\n";
+
+	out += "<g fill=\"none\">\n";
+	for(size_t i = 0;i < edges.size();i++){
+		if(out.size() >= WRITE_CHUNK_SIZE){
+			os.write(out.data(), out.size());
+			out.clear();
+		}
+		const Edge& e = edges[i];
+		if(!e.present || !hasNode(e.v1) || !hasNode(e.v2))
+			continue;
+		int x1 = pos[e.v1].first, y1 = pos[e.v1].second;
+		int x2 = pos[e.v2].first, y2 = pos[e.v2].second;
+		out += "<path d=\"M";
+		appendInt(out, x1);
+		out += ' ';
+		appendInt(out, y1);
+		if(edgesCurved){
+			out += 'Q';
+			appendInt(out, (x1 + x2)/2 + (y2 - y1)/8);
+			out += ' ';
+			appendInt(out, (y1 + y2)/2 - (x2 - x1)/8);
+			out += ' ';
+		}
+		else
+			out += 'L';
+		appendInt(out, x2);
+		out += ' ';
+		appendInt(out, y2);
+		out += "\" stroke=\"";
+		out += text[e.color != 0 ? e.color : edgeColor];
+		out += '"';
+		if(e.thickness > 1)
+			appendf(out, " stroke-width=\"%d\"", e.thickness);
+		if(e.dashedSet ? e.dashed : edgesDashed)
+			out += " stroke-dasharray=\"6,4\"";
+		if(e.directed)
+			out += " marker-end=\"url(#arrow)\"";
+		if(e.weightSet || e.flowSet){
+			out += "><title>";
+			if(e.weightSet){
+				out += "weight ";
+				appendInt(out, e.weight);
+				out += ' ';
+			}
+			if(e.flowSet){
+				out += "flow ";
+				appendInt(out, e.flow);
+			}
+			out += "</title></path>\n";
+		}
+		else
+			out += "/>\n";
+		if(!e.label.empty()){
+			appendf(out, "<text x=\"%d\" y=\"%d\" fill=\"black\" font-size=\"10\">", (x1 + x2)/2, (y1 + y2)/2);
+			appendXml(out, e.label);
+			out += "</text>\n";
+		}
+	}
+	out += "</g>\n<g>\n";
+
+	for(size_t i = 0;i < nodes.size();i++){
+		if(out.size() >= WRITE_CHUNK_SIZE){
+			os.write(out.data(), out.size());
+			out.clear();
+		}
+		const Node& n = nodes[i];
+		if(!n.present)
+			continue;
+		int size = n.size != 0 ? n.size : vertexSize;
+		uint32_t icon = n.icon != 0 ? n.icon : vertexIcon;
+		if(icon != 0){
+			appendf(out, "<image x=\"%d\" y=\"%d\" width=\"%d\" height=\"%d\" xlink:href=\"",
+					pos[i].first - size/2, pos[i].second - size/2, size, size);
+			appendXml(out, names.get(icon));
+			out += "\"/>\n";
+		}
+		else{
+			out += "<circle cx=\"";
+			appendInt(out, pos[i].first);
+			out += "\" cy=\"";
+			appendInt(out, pos[i].second);
+			out += "\" r=\"";
+			appendInt(out, size/2);
+			if(size % 2 != 0)
+				out += ".5";
+			out += "\" fill=\"";
+			out += text[n.color != 0 ? n.color : vertexColor];
+			out += "\"/>\n";
+		}
+		if(!n.label.empty()){
+			appendf(out, "<text x=\"%d\" y=\"%d\" font-size=\"10\">", pos[i].first + size/2 + 2, pos[i].second - size/2);
+			appendXml(out, n.label);
+			out += "</text>\n";
+		}
+	}
+	out += "</g>\n</svg>\n";
+	os.write(out.data(), out.size());
+}
+
+/**
+ * Positions are in points with the y axis going up, so that "neato -n"
+ * draws the nodes where the viewer would.
+ */
+void HeadlessRenderer::writeDot(ostream& os) const {
+	string out;
+	out.reserve(WRITE_CHUNK_SIZE + 4096);
+	vector<pair<int,int> > pos;
+	layout(pos);
+	vector<string> text = namesOf(names);
+
+	out += "digraph G {\n";
+	appendf(out, "\tgraph [bb=\"0,0,%d,%d\", bgcolor=\"lightgray\", splines=%s, outputorder=edgesfirst];\n",
+			width, height, edgesCurved ? "curved" : "line");
+	out += "\tnode [shape=circle, style=filled, fixedsize=true, label=\"\"];\n";
+
+	int lastSize = -1;
+	string width;		//of the last size, in inches
+
+	for(size_t i = 0;i < nodes.size();i++){
+		if(out.size() >= WRITE_CHUNK_SIZE){
+			os.write(out.data(), out.size());
+			out.clear();
+		}
+		const Node& n = nodes[i];
+		if(!n.present)
+			continue;
+		int size = n.size != 0 ? n.size : vertexSize;
+		uint32_t icon = n.icon != 0 ? n.icon : vertexIcon;
+		if(size != lastSize){
+			char buff[32];
+			sprintf(buff, "%g", size/72.0);
+			width = buff;
+			lastSize = size;
+		}
+		out += '\t';
+		appendInt(out, i);
+		out += " [pos=\"";
+		appendInt(out, pos[i].first);
+		out += ',';
+		appendInt(out, height - pos[i].second);
+		out += "!\", width=";
+		out += width;
+		out += ", fillcolor=\"";
+		out += text[n.color != 0 ? n.color : vertexColor];
+		out += '"';
+		if(icon != 0){
+			out += ", shape=none, image=\"";
+			appendDot(out, names.get(icon));
+			out += "\"";
+		}
+		if(!n.label.empty()){
+			out += ", xlabel=\"";
+			appendDot(out, n.label);
+			out += "\"";
+		}
+		out += "];\n";
+	}
+
+	for(size_t i = 0;i < edges.size();i++){
+		if(out.size() >= WRITE_CHUNK_SIZE){
+			os.write(out.data(), out.size());
+			out.clear();
+		}
+		const Edge& e = edges[i];
+		if(!e.present || !hasNode(e.v1) || !hasNode(e.v2))
+			continue;
+		out += '\t';
+		appendInt(out, e.v1);
+		out += " -> ";
+		appendInt(out, e.v2);
+		out += " [id=";
+		appendInt(out, i);
+		out += ", color=\"";
+		out += text[e.color != 0 ? e.color : edgeColor];
+		out += '"';
+		if(!e.directed)
+			out += ", dir=none";
+		if(e.thickness > 1)
+			appendf(out, ", penwidth=%d", e.thickness);
+		if(e.dashedSet ? e.dashed : edgesDashed)
+			out += ", style=dashed";
+		if(!e.label.empty()){
+			out += ", label=\"";
+			appendDot(out, e.label);
+			out += "\"";
+		}
+		out += "];\n";
+	}
+	out += "}\n";
+	os.write(out.data(), out.size());
+}
+
+/**
+ * Writes the current drawing to path in the format of the renderer.
+ */
+bool HeadlessRenderer::write(const string& path) const {
+	ofstream ofs(path.c_str(), ios::binary);
+	if(ofs.is_open() == false)
+		return false;
+	if(format == DOT)
+		writeDot(ofs);
+	else
+		writeSvg(ofs);
+	return ofs.good();
+}
@@ -0,0 +1,118 @@
+/*
+ * HeadlessRenderer.h
+ */
+
+#ifndef SRC_HEADLESSRENDERER_H_
+#define SRC_HEADLESSRENDERER_H_
+
+#include <vector>
+#include <string>
+#include <ostream>
+#include <stdint.h>
+#include "GraphRenderer.h"
+#include "StringPool.h"
+
+using namespace std;
+
+/**
+ * Draws the graph in process, without a display or a viewer. Nodes and edges
+ * are kept in arrays indexed by id, with colours and icons interned, and every
+ * flush writes the whole drawing to a file as SVG or as Graphviz DOT (with
+ * fixed positions, for neato -n). Nothing is written while nothing changed.
+ *
+ * Nodes added without coordinates are laid out on a circle.
+ */
+class HeadlessRenderer: public GraphRenderer {
+
+public:
+	enum Format { SVG, DOT };
+
+	static const int DEFAULT_VERTEX_SIZE = 10;
+	static const size_t WRITE_CHUNK_SIZE = 1 << 20;
+
+private:
+	struct Node {
+		bool present;
+		bool placed;
+		int x, y;
+		int size;			//0 for the default size
+		uint32_t color;		//0 for the default colour
+		uint32_t icon;
+		string label;
+	};
+
+	struct Edge {
+		bool present;
+		bool directed;
+		bool dashedSet;
+		bool dashed;
+		int v1, v2;
+		int thickness;
+		bool weightSet, flowSet;
+		int weight, flow;
+		uint32_t color;
+		string label;
+	};
+
+	string path;
+	Format format;
+	int width, height;
+	bool dirty;
+
+	vector<Node> nodes;
+	vector<Edge> edges;
+	StringPool names;		//colours and file paths, "" has id 0
+
+	uint32_t vertexColor, edgeColor, vertexIcon, background;
+	int vertexSize;
+	bool edgesDashed, edgesCurved;
+
+	Node* node(int id, bool create = false);
+	Edge* edge(int id, bool create = false);
+	bool hasNode(int id) const;
+	uint32_t colorOf(const string& color);
+	void layout(vector<pair<int,int> >& positions) const;
+	void writeSvg(ostream& os) const;
+	void writeDot(ostream& os) const;
+
+public:
+	HeadlessRenderer(int width, int height, const string& path);
+	HeadlessRenderer(int width, int height, const string& path, Format format);
+	virtual ~HeadlessRenderer();
+
+	static Format formatOf(const string& path);
+	bool write(const string& path) const;
+
+	bool createWindow(int width, int height);
+	bool closeWindow();
+
+	bool addNode(int id, int x, int y);
+	bool addNode(int id);
+	bool addEdge(int id, int v1, int v2, int edgeType);
+	bool removeNode(int id);
+	bool removeEdge(int id);
+
+	bool setVertexLabel(int id, string label);
+	bool setEdgeLabel(int id, string label);
+	bool setEdgeColor(int id, string color);
+	bool setEdgeDashed(int id, bool dashed);
+	bool setVertexColor(int id, string color);
+	bool setVertexSize(int id, int size);
+	bool setVertexIcon(int id, string filepath);
+	bool setEdgeThickness(int id, int thickness);
+	bool setEdgeWeight(int id, int weight);
+	bool setEdgeFlow(int id, int flow);
+
+	bool defineEdgeCurved(bool curved);
+	bool defineEdgeColor(string color);
+	bool defineEdgeDashed(bool dashed);
+	bool defineVertexColor(string color);
+	bool defineVertexSize(int size);
+	bool defineVertexIcon(string filepath);
+	bool setBackground(string path);
+
+	bool rearrange();
+	bool flush();
+};
+
+#endif /* SRC_HEADLESSRENDERER_H_ */
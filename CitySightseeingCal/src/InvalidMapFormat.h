@@ -0,0 +1,29 @@
+#ifndef SRC_INVALIDMAPFORMAT_H_
+#define SRC_INVALIDMAPFORMAT_H_
+
+#include <string>
+
+using namespace std;
+
+class InvalidMapFormat {
+private:
+	string nameOfFile;
+	string reason;
+public:
+	InvalidMapFormat(string namefl, string reason){
+		this->nameOfFile = namefl;
+		this->reason = reason;
+	}
+
+	virtual ~InvalidMapFormat(){}
+
+	string getNameOfFile(){
+		return nameOfFile;
+	}
+
+	string getReason(){
+		return reason;
+	}
+};
+
+#endif /* SRC_INVALIDMAPFORMAT_H_ */
@@ -0,0 +1,275 @@
+/*
+ * JsonReader.h
+ */
+
+#ifndef SRC_JSONREADER_H_
+#define SRC_JSONREADER_H_
+
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cmath>
+#include <climits>
+
+using namespace std;
+
+/**
+ * Parsed JSON value. Objects keep their members in document order.
+ */
+struct JsonValue {
+	enum Type { NUL, BOOLEAN, NUMBER, STRING, ARRAY, OBJECT };
+	Type type;
+	bool flag;				//value of a BOOLEAN
+	double number;
+	string text;
+	vector<JsonValue> items;
+	vector<pair<string, JsonValue> > members;
+
+	JsonValue(): type(NUL), flag(false), number(0) {}
+
+	/**
+	 * Member called key of an object, NULL if there is none.
+	 */
+	const JsonValue* get(const string& key) const {
+		for(size_t i = 0;i < members.size();i++)
+			if(members[i].first == key)
+				return &members[i].second;
+		return NULL;
+	}
+
+	bool isInt() const { return type == NUMBER && number >= INT_MIN && number <= INT_MAX && number == (int) number; }
+};
+
+/**
+ * Minimal JSON parser, the counterpart of JsonWriter, for one document per
+ * call (a line of a newline-delimited stream). Nesting is limited to
+ * MAX_DEPTH so that malicious input can not exhaust the stack.
+ * Example: JsonValue v; if(JsonReader(line).parse(v)) ... v.get("id") ...
+ */
+class JsonReader {
+
+public:
+	static const int MAX_DEPTH = 64;
+
+private:
+	const string& s;
+	size_t pos;
+
+	void skipSpaces(){
+		while(pos < s.size() && (s[pos] == ' ' || s[pos] == '\t' || s[pos] == '\n' || s[pos] == '\r'))
+			pos++;
+	}
+
+	bool consume(const char* word){
+		size_t i = 0;
+		while(word[i] != '\0'){
+			if(pos + i >= s.size() || s[pos + i] != word[i])
+				return false;
+			i++;
+		}
+		pos += i;
+		return true;
+	}
+
+	static void appendUtf8(string& out, unsigned long c){
+		if(c < 0x80)
+			out += (char) c;
+		else if(c < 0x800){
+			out += (char) (0xC0 | (c >> 6));
+			out += (char) (0x80 | (c & 0x3F));
+		}
+		else if(c < 0x10000){
+			out += (char) (0xE0 | (c >> 12));
+			out += (char) (0x80 | ((c >> 6) & 0x3F));
+			out += (char) (0x80 | (c & 0x3F));
+		}
+		else{
+			out += (char) (0xF0 | (c >> 18));
+			out += (char) (0x80 | ((c >> 12) & 0x3F));
+			out += (char) (0x80 | ((c >> 6) & 0x3F));
+			out += (char) (0x80 | (c & 0x3F));
+		}
+	}
+
+	bool isDigit(size_t i) const {
+		return i < s.size() && s[i] >= '0' && s[i] <= '9';
+	}
+
+	/**
+	 * Reads a number of the JSON grammar, -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)?,
+	 * which strtod alone would widen with nan, inf, hex and leading '+'.
+	 * Values that overflow a double are rejected too.
+	 */
+	bool parseNumber(double& out){
+		size_t end = pos;
+		if(end < s.size() && s[end] == '-')
+			end++;
+		if(!isDigit(end))
+			return false;
+		if(s[end] == '0')
+			end++;
+		else
+			while(isDigit(end))
+				end++;
+		if(end < s.size() && s[end] == '.'){
+			end++;
+			if(!isDigit(end))
+				return false;
+			while(isDigit(end))
+				end++;
+		}
+		if(end < s.size() && (s[end] == 'e' || s[end] == 'E')){
+			end++;
+			if(end < s.size() && (s[end] == '+' || s[end] == '-'))
+				end++;
+			if(!isDigit(end))
+				return false;
+			while(isDigit(end))
+				end++;
+		}
+		out = strtod(s.substr(pos, end - pos).c_str(), NULL);
+		if(!std::isfinite(out))
+			return false;
+		pos = end;
+		return true;
+	}
+
+	bool readHex4(unsigned long& c){
+		if(pos + 4 > s.size())
+			return false;
+		char* end;
+		string digits = s.substr(pos, 4);
+		c = strtoul(digits.c_str(), &end, 16);
+		if(end != digits.c_str() + 4)
+			return false;
+		pos += 4;
+		return true;
+	}
+
+	bool parseString(string& out){
+		if(pos >= s.size() || s[pos] != '"')
+			return false;
+		pos++;
+		while(pos < s.size()){
+			char c = s[pos++];
+			if(c == '"')
+				return true;
+			if(c != '\\'){
+				out += c;
+				continue;
+			}
+			if(pos >= s.size())
+				return false;
+			c = s[pos++];
+			switch(c){
+			case '"': case '\\': case '/': out += c; break;
+			case 'b': out += '\b'; break;
+			case 'f': out += '\f'; break;
+			case 'n': out += '\n'; break;
+			case 'r': out += '\r'; break;
+			case 't': out += '\t'; break;
+			case 'u': {
+				unsigned long code, low;
+				if(!readHex4(code))
+					return false;
+				if(code >= 0xD800 && code < 0xDC00 && consume("\\u") && readHex4(low)
+						&& low >= 0xDC00 && low < 0xE000)
+					code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+				appendUtf8(out, code);
+				break;
+			}
+			default:
+				return false;
+			}
+		}
+		return false;
+	}
+
+	bool parseValue(JsonValue& v, int depth){
+		if(depth > MAX_DEPTH)
+			return false;
+		skipSpaces();
+		if(pos >= s.size())
+			return false;
+		char c = s[pos];
+		if(c == '{'){
+			v.type = JsonValue::OBJECT;
+			pos++;
+			skipSpaces();
+			if(pos < s.size() && s[pos] == '}'){
+				pos++;
+				return true;
+			}
+			while(true){
+				skipSpaces();
+				v.members.push_back(pair<string, JsonValue>());
+				if(!parseString(v.members.back().first))
+					return false;
+				skipSpaces();
+				if(!consume(":") || !parseValue(v.members.back().second, depth + 1))
+					return false;
+				skipSpaces();
+				if(consume("}"))
+					return true;
+				if(!consume(","))
+					return false;
+			}
+		}
+		if(c == '['){
+			v.type = JsonValue::ARRAY;
+			pos++;
+			skipSpaces();
+			if(pos < s.size() && s[pos] == ']'){
+				pos++;
+				return true;
+			}
+			while(true){
+				v.items.push_back(JsonValue());
+				if(!parseValue(v.items.back(), depth + 1))
+					return false;
+				skipSpaces();
+				if(consume("]"))
+					return true;
+				if(!consume(","))
+					return false;
+			}
+		}
+		if(c == '"'){
+			v.type = JsonValue::STRING;
+			return parseString(v.text);
+		}
+		if(consume("true")){
+			v.type = JsonValue::BOOLEAN;
+			v.flag = true;
+			return true;
+		}
+		if(consume("false")){
+			v.type = JsonValue::BOOLEAN;
+			return true;
+		}
+		if(consume("null"))
+			return true;
+
+		if(!parseNumber(v.number))
+			return false;
+		v.type = JsonValue::NUMBER;
+		return true;
+	}
+
+public:
+	JsonReader(const string& s): s(s), pos(0) {}
+	virtual ~JsonReader(){}
+
+	/**
+	 * False if the text is not exactly one JSON value.
+	 */
+	bool parse(JsonValue& v){
+		v = JsonValue();
+		if(!parseValue(v, 0))
+			return false;
+		skipSpaces();
+		return pos == s.size();
+	}
+};
+
+#endif /* SRC_JSONREADER_H_ */
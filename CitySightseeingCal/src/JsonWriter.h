@@ -0,0 +1,115 @@
+/*
+ * JsonWriter.h
+ */
+
+#ifndef SRC_JSONWRITER_H_
+#define SRC_JSONWRITER_H_
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+
+using namespace std;
+
+/**
+ * Minimal streaming JSON writer, takes care of commas and string escaping.
+ * Example: w.beginObject(); w.key("id"); w.value(3); w.endObject();
+ */
+class JsonWriter {
+
+private:
+	ostream& os;
+	vector<bool> firstInScope;
+	bool afterKey;
+
+	void separate(){
+		if(afterKey){
+			afterKey = false;
+			return;
+		}
+		if(!firstInScope.empty()){
+			if(!firstInScope.back())
+				os << ',';
+			firstInScope.back() = false;
+		}
+	}
+
+	void writeString(const string& s){
+		os << '"';
+		for(size_t i = 0;i < s.size();i++){
+			unsigned char c = s[i];
+			if(c == '"' || c == '\\')
+				os << '\\' << c;
+			else if(c == '\n')
+				os << "\\n";
+			else if(c == '\r')
+				os << "\\r";
+			else if(c == '\t')
+				os << "\\t";
+			else if(c < 0x20){
+				char buff[8];
+				sprintf(buff, "\\u%04x", c);
+				os << buff;
+			}
+			else
+				os << c;
+		}
+		os << '"';
+	}
+
+public:
+	JsonWriter(ostream& os): os(os), afterKey(false) {}
+	virtual ~JsonWriter(){}
+
+	void beginObject(){ separate(); os << '{'; firstInScope.push_back(true); }
+	void endObject(){ firstInScope.pop_back(); os << '}'; }
+	void beginArray(){ separate(); os << '['; firstInScope.push_back(true); }
+	void endArray(){ firstInScope.pop_back(); os << ']'; }
+
+	void key(const string& k){
+		separate();
+		writeString(k);
+		os << ':';
+		afterKey = true;
+	}
+
+	void value(const string& v){ separate(); writeString(v); }
+	void value(const char* v){ value(string(v)); }
+	void value(int v){ separate(); os << v; }
+	void value(long long v){ separate(); os << v; }
+	void value(size_t v){ separate(); os << v; }
+	void value(bool v){ separate(); os << (v ? "true" : "false"); }
+	/**
+	 * Shortest of %.15g and %.17g that reads back as the same double, so that
+	 * large distances keep every digit. JSON has no nan or infinity, so they
+	 * are written as null.
+	 */
+	void value(double v){
+		separate();
+		if(!std::isfinite(v)){
+			os << "null";
+			return;
+		}
+		char buff[32];
+		sprintf(buff, "%.15g", v);
+		if(strtod(buff, NULL) != v)
+			sprintf(buff, "%.17g", v);
+		os << buff;
+	}
+	void null(){ separate(); os << "null"; }
+
+	/**
+	 * The numbers as a JSON array.
+	 */
+	void values(const vector<int>& v){
+		beginArray();
+		for(size_t i = 0;i < v.size();i++)
+			value(v[i]);
+		endArray();
+	}
+};
+
+#endif /* SRC_JSONWRITER_H_ */
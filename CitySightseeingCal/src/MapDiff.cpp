@@ -0,0 +1,79 @@
+/*
+ * MapDiff.cpp
+ */
+
+#include <cstring>
+#include <algorithm>
+#include "MapDiff.h"
+#include "MappedFile.h"
+#include "FieldScanner.h"
+#include "FileNotExists.h"
+
+static bool fieldIs(const char* begin, const char* end, const char* word){
+	size_t n = strlen(word);
+	return (size_t)(end - begin) == n && memcmp(begin, word, n) == 0;
+}
+
+void MapDiff::readFromFile(string diffFlName){
+	MappedFile fl;
+	if(fl.open(diffFlName) == false)
+		throw FileNotExists(diffFlName);
+	readFromBuffer(fl.begin(), fl.end());
+}
+
+void MapDiff::readFromBuffer(const char* begin, const char* end){
+	FieldScanner sc(begin, end);
+	const char *b, *e;
+
+	while(sc.nextLine()){
+		DiffOperation op;
+		op.origin = op.dest = -1;
+		op.latDeg = op.longDeg = op.weight = 0;
+		op.twoWay = false;
+
+		sc.readField(b, e);
+		if(b < e && *b == '#')
+			continue;
+		if(!sc.readInt(op.id))
+			continue;
+
+		if(fieldIs(b, e, "addNode")){
+			op.type = DiffOperation::ADD_NODE;
+			if(!sc.readDouble(op.latDeg) || !sc.readDouble(op.longDeg))
+				continue;
+		}
+		else if(fieldIs(b, e, "removeNode"))
+			op.type = DiffOperation::REMOVE_NODE;
+		else if(fieldIs(b, e, "addEdge") || fieldIs(b, e, "removeEdge") || fieldIs(b, e, "setWeight")){
+			op.type = fieldIs(b, e, "addEdge") ? DiffOperation::ADD_EDGE :
+					fieldIs(b, e, "removeEdge") ? DiffOperation::REMOVE_EDGE : DiffOperation::SET_WEIGHT;
+			if(!sc.readInt(op.origin) || !sc.readInt(op.dest))
+				continue;
+			if(op.type == DiffOperation::SET_WEIGHT && !sc.readDouble(op.weight))
+				continue;
+		}
+		else if(fieldIs(b, e, "setRoad")){
+			op.type = DiffOperation::SET_ROAD;
+			sc.readField(b, e);
+			op.name = string(b, e);
+			sc.readField(b, e);
+			op.twoWay = fieldIs(b, e, "True");
+		}
+		else
+			continue;
+		operations.push_back(op);
+	}
+}
+
+/**
+ * Every edge that was added, removed, reweighted or redirected, without repetitions.
+ */
+vector<int> MapChanges::getChangedEdges() const {
+	vector<int> res(addedEdges);
+	res.insert(res.end(), removedEdges.begin(), removedEdges.end());
+	res.insert(res.end(), reweightedEdges.begin(), reweightedEdges.end());
+	res.insert(res.end(), redirectedEdges.begin(), redirectedEdges.end());
+	sort(res.begin(), res.end());
+	res.erase(unique(res.begin(), res.end()), res.end());
+	return res;
+}
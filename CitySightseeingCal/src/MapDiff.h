@@ -0,0 +1,79 @@
+/*
+ * MapDiff.h
+ */
+
+#ifndef SRC_MAPDIFF_H_
+#define SRC_MAPDIFF_H_
+
+#include <vector>
+#include <string>
+
+using namespace std;
+
+typedef long long int ll;
+
+/**
+ * One change of a diff. Nodes, roads and edges are identified by their OSM ids,
+ * as in nodes.txt, roads.txt and edges.txt.
+ */
+struct DiffOperation {
+	enum Type { ADD_NODE, REMOVE_NODE, ADD_EDGE, REMOVE_EDGE, SET_WEIGHT, SET_ROAD };
+	Type type;
+	ll id;					//node of ADD_NODE/REMOVE_NODE, road of the others
+	ll origin, dest;		//nodes of the edge
+	double latDeg, longDeg;
+	double weight;
+	string name;
+	bool twoWay;
+};
+
+/**
+ * Changes to the map read from a diff file, one per line, fields separated by ';':
+ *
+ *   addNode;idNode;latDeg;longDeg
+ *   removeNode;idNode							(its edges are removed too)
+ *   addEdge;idRoad;idNodeOrigin;idNodeDest	(weight is the distance between the nodes)
+ *   removeEdge;idRoad;idNodeOrigin;idNodeDest
+ *   setWeight;idRoad;idNodeOrigin;idNodeDest;weight
+ *   setRoad;idRoad;name;True|False			(adds the road, or renames it and changes its direction)
+ *
+ * Lines starting with '#' and lines that can not be parsed are ignored.
+ * The operations are applied in file order by MapReading::applyDiff.
+ */
+class MapDiff {
+
+private:
+	vector<DiffOperation> operations;
+
+public:
+	MapDiff(){};
+	virtual ~MapDiff(){};
+
+	void readFromFile(string diffFlName);
+	void readFromBuffer(const char* begin, const char* end);
+	void add(const DiffOperation& op) { operations.push_back(op); }
+	const vector<DiffOperation>& getOperations() const { return operations; }
+	size_t size() const { return operations.size(); }
+};
+
+/**
+ * What a diff changed, in dense ids, so that only the structures that depend on
+ * it are updated: the spatial index depends on the nodes, the CompactGraph on
+ * the topology (its weights can be updated in place), and the Floyd-Warshall
+ * matrices, distance tables and contracted graphs on any edge change.
+ */
+struct MapChanges {
+	vector<int> addedNodes;
+	vector<int> removedNodes;
+	vector<int> addedEdges;
+	vector<int> removedEdges;
+	vector<int> reweightedEdges;
+	vector<int> redirectedEdges;		//two-way flag changed
+
+	bool affectsNodes() const { return !addedNodes.empty() || !removedNodes.empty(); }
+	bool affectsTopology() const { return affectsNodes() || !addedEdges.empty() || !removedEdges.empty() || !redirectedEdges.empty(); }
+	bool affectsEdges() const { return affectsTopology() || !reweightedEdges.empty(); }
+	vector<int> getChangedEdges() const;
+};
+
+#endif /* SRC_MAPDIFF_H_ */
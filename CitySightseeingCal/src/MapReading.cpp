@@ -1,4 +1,10 @@
+#include <algorithm>
+#include <cstring>
 #include "MapReading.h"
+#include "FieldScanner.h"
+#include "BinaryMapFormat.h"
+#include "InvalidMapFormat.h"
+#include "ThreadPool.h"
 
 /**
  * Calculate the distance between two points
@@ -7,91 +13,844 @@ double dist(pair<double,double> p1, pair<double,double> p2){
 	return sqrt((p1.first-p2.first)*(p1.first-p2.first)+(p1.second-p2.second)*(p1.second-p2.second));
 }
 
+/**
+ * Lines parsed from one chunk of each file, kept apart until every chunk is done
+ * so that they can be merged in file order.
+ */
+struct MapReading::RoadsChunk {
+	vector<ll> idRoads;
+	vector<pair<const char*, const char*> > names;	//in the buffer being read
+	vector<bool> twoWay;
+};
+
+struct MapReading::NodesChunk {
+	vector<ll> idNodes;
+	vector<pair<double,double> > coords;
+};
+
+struct MapReading::EdgesChunk {
+	vector<ll> idRoads;
+	vector<ll> origins;
+	vector<ll> dests;
+	vector<int> o;
+	vector<int> d;
+	vector<double> weights;
+	vector<bool> twoWay;
+};
+
+typedef pair<const char*, const char*> Range;
+
+/**
+ * Compares the id of the entries of the sorted id tables (mapNodes, roads).
+ */
+template <class V>
+struct id_less_than {
+	bool operator()(const pair<ll, V>& a, const pair<ll, V>& b) const { return a.first < b.first; }
+	bool operator()(const pair<ll, V>& a, ll b) const { return a.first < b; }
+};
+
+/**
+ * Sorts a table by id. When an id appears more than once the entry read last wins,
+ * as it did when the tables were std::maps.
+ */
+template <class V>
+static void sortById(vector<pair<ll, V> >& table){
+	stable_sort(table.begin(), table.end(), id_less_than<V>());
+	size_t n = 0;
+	for(size_t i = 0;i < table.size();i++){
+		if(i+1 < table.size() && table[i+1].first == table[i].first)
+			continue;
+		if(n != i)
+			swap(table[n], table[i]);
+		n++;
+	}
+	table.resize(n);
+}
+
+template <class V>
+static int findById(const vector<pair<ll, V> >& table, ll id){
+	typename vector<pair<ll, V> >::const_iterator it = lower_bound(table.begin(), table.end(), id, id_less_than<V>());
+	if(it == table.end() || it->first != id)
+		return -1;
+	return it - table.begin();
+}
+
+/**
+ * Splits a buffer in at most maxChunks pieces that start at the beginning of a line.
+ * Small buffers give a single chunk.
+ */
+static vector<Range> splitInLines(const char* begin, const char* end, int maxChunks){
+	const size_t minChunkSize = 1 << 18;
+	size_t size = end - begin;
+	size_t numChunks = min((size_t) maxChunks, size / minChunkSize);
+	if(numChunks < 1)
+		numChunks = 1;
+
+	vector<Range> chunks;
+	const char* start = begin;
+	for(size_t i = 1;i <= numChunks && start < end;i++){
+		const char* stop = (i == numChunks) ? end : begin + size / numChunks * i;
+		if(stop < start)
+			stop = start;
+		while(stop < end && *stop != '\n')
+			stop++;
+		if(stop < end)
+			stop++;
+		chunks.push_back(Range(start, stop));
+		start = stop;
+	}
+	return chunks;
+}
+
+/**
+ * Lines of roads.txt: idRoad;name;True|False (True for two-way roads)
+ */
+void MapReading::parseRoads(const char* begin, const char* end, RoadsChunk& chunk){
+	FieldScanner sc(begin, end);
+	ll idRoad;
+	const char *nameBegin, *nameEnd, *wayBegin, *wayEnd;
+
+	while(sc.nextLine()){
+		if(!sc.readInt(idRoad))
+			continue;
+		sc.readField(nameBegin, nameEnd);
+		sc.readField(wayBegin, wayEnd);
+		chunk.idRoads.push_back(idRoad);
+		chunk.names.push_back(make_pair(nameBegin, nameEnd));
+		chunk.twoWay.push_back(wayEnd - wayBegin == 4 && memcmp(wayBegin, "True", 4) == 0);
+	}
+}
+
+/**
+ * Lines of nodes.txt: idNode;latDeg;longDeg;longRad;latRad
+ */
+void MapReading::parseNodes(const char* begin, const char* end, NodesChunk& chunk){
+	FieldScanner sc(begin, end);
+	ll idNodeLong;
+	double longRad, latRad;
+
+	while(sc.nextLine()){
+		if(!sc.readInt(idNodeLong))
+			continue;
+		sc.skipField();
+		sc.skipField();
+		if(!sc.readDouble(longRad) || !sc.readDouble(latRad))
+			continue;
+		chunk.idNodes.push_back(idNodeLong);
+		chunk.coords.push_back(projectRadians(latRad, longRad));
+	}
+}
+
+/**
+ * Lines of edges.txt: idRoad;idOriginNode;idDestNode;
+ * The node ids are resolved later, once every node is known.
+ */
+void MapReading::parseEdges(const char* begin, const char* end, EdgesChunk& chunk){
+	FieldScanner sc(begin, end);
+	ll idRoad, origin, dest;
+
+	while(sc.nextLine()){
+		if(!sc.readInt(idRoad) || !sc.readInt(origin) || !sc.readInt(dest))
+			continue;
+		chunk.idRoads.push_back(idRoad);
+		chunk.origins.push_back(origin);
+		chunk.dests.push_back(dest);
+	}
+}
+
+/**
+ * Appends the roads of a chunk. indexRoads must be called before looking them up.
+ */
+void MapReading::mergeRoads(const RoadsChunk& chunk){
+	for(size_t i = 0;i < chunk.idRoads.size();i++)
+		roads.push_back(make_pair(chunk.idRoads[i], pair<uint32_t,bool>(roadNames.intern(chunk.names[i].first, chunk.names[i].second),chunk.twoWay[i])));
+}
+
+/**
+ * Appends the nodes of a chunk. indexNodes must be called before looking them up.
+ */
+void MapReading::mergeNodes(const NodesChunk& chunk){
+	int idNode = nodes.size();
+	nodes.insert(nodes.end(), chunk.coords.begin(), chunk.coords.end());
+	nameOfNodes.resize(nodes.size());
+	for(size_t i = 0;i < chunk.idNodes.size();i++)
+		mapNodes.push_back(pair<ll,int>(chunk.idNodes[i], idNode++));
+}
+
+void MapReading::indexNodes(){
+	sortById(mapNodes);
+}
+
+void MapReading::indexRoads(){
+	sortById(roads);
+}
+
+/**
+ * Dense id of the node with the given OSM id, or -1 if there is none.
+ */
+int MapReading::findNode(ll idNode) const {
+	int i = findById(mapNodes, idNode);
+	return i == -1 ? -1 : mapNodes[i].second;
+}
+
+/**
+ * Position of the road in the roads table, or -1 if there is none.
+ */
+int MapReading::findRoad(ll idRoad) const {
+	return findById(roads, idRoad);
+}
+
+/**
+ * Name of the road of an edge, empty if the road is not in roads.txt.
+ */
+string MapReading::getRoadName(int idEdge) const {
+	int r = findRoad(mapIdEdgeToIdRoad[idEdge]);
+	return r == -1 ? "" : roadNames.get(roads[r].second.first);
+}
+
+bool MapReading::isEdgeRemoved(int idEdge) const {
+	return idEdge < (int)removedEdges.size() && removedEdges[idEdge];
+}
+
+bool MapReading::isNodeRemoved(int idNode) const {
+	return idNode < (int)removedNodes.size() && removedNodes[idNode];
+}
+
+/**
+ * Id of the edge of the road between two nodes, or -1 if there is none.
+ * Linear in the number of edges of origin; needs indexIncidentEdges.
+ */
+int MapReading::findEdge(ll idRoad, int origin, int dest) const {
+	if(origin == -1 || dest == -1)
+		return -1;
+	const vector<int>& incident = edgesOfNode[origin];
+	for(size_t k = 0;k < incident.size();k++){
+		int i = incident[k];
+		if(edges[i].first == origin && edges[i].second == dest && mapIdEdgeToIdRoad[i] == idRoad && !isEdgeRemoved(i))
+			return i;
+	}
+	return -1;
+}
+
+/**
+ * Lists the edges of every node, once: applyDiff keeps the lists up to date
+ * and reorderNodes drops them.
+ */
+void MapReading::indexIncidentEdges(){
+	if(edgesOfNode.size() == nodes.size())
+		return;
+	edgesOfNode.assign(nodes.size(), vector<int>());
+	for(size_t i = 0;i < edges.size();i++)
+		addIncidentEdge(i);
+}
+
+void MapReading::addIncidentEdge(int idEdge){
+	edgesOfNode[edges[idEdge].first].push_back(idEdge);
+	if(edges[idEdge].second != edges[idEdge].first)
+		edgesOfNode[edges[idEdge].second].push_back(idEdge);
+}
+
+void MapReading::removeEdge(int idEdge, MapChanges& changes){
+	if(removedEdges.size() < edges.size())
+		removedEdges.resize(edges.size(), false);
+	removedEdges[idEdge] = true;
+	changes.removedEdges.push_back(idEdge);
+}
+
+/**
+ * Applies the operations of a diff in place. Node and edge ids never change:
+ * new nodes and edges get the next ids, and removed edges keep their id but are
+ * skipped by getGraph, getCompactGraph and sendDataToGraphViewer. A removed node
+ * loses its edges and its OSM id, and stays as an isolated vertex that the
+ * spatial index, the viewer and writeBinaryMap leave out.
+ * Operations on nodes, roads or edges that do not exist are ignored.
+ *
+ * Node and edge operations only look at the edges of their nodes. Roads whose
+ * direction changes are applied to their edges in one pass at the end.
+ */
+MapChanges MapReading::applyDiff(const MapDiff& diff){
+	MapChanges changes;
+	const vector<DiffOperation>& ops = diff.getOperations();
+	vector<pair<ll,bool> > redirectedRoads;			//final direction of the roads that changed it
+	indexIncidentEdges();
+
+	for(size_t k = 0;k < ops.size();k++){
+		const DiffOperation& op = ops[k];
+		if(op.type == DiffOperation::ADD_NODE){
+			if(findNode(op.id) != -1)
+				continue;
+			int idNode = nodes.size();
+			nodes.push_back(project(op.latDeg, op.longDeg));
+			nameOfNodes.resize(nodes.size());
+			edgesOfNode.resize(nodes.size());
+			if(!fileOrderOfNode.empty()){
+				fileOrderOfNode.push_back(idNode);
+				nodeOfFileOrder.push_back(idNode);
+			}
+			mapNodes.insert(lower_bound(mapNodes.begin(), mapNodes.end(), op.id, id_less_than<int>()), pair<ll,int>(op.id, idNode));
+			changes.addedNodes.push_back(idNode);
+		}
+		else if(op.type == DiffOperation::REMOVE_NODE){
+			int i = findById(mapNodes, op.id);
+			if(i == -1)
+				continue;
+			int idNode = mapNodes[i].second;
+			mapNodes.erase(mapNodes.begin() + i);
+			const vector<int>& incident = edgesOfNode[idNode];
+			for(size_t k = 0;k < incident.size();k++)
+				if(!isEdgeRemoved(incident[k]))
+					removeEdge(incident[k], changes);
+			if(removedNodes.size() < nodes.size())
+				removedNodes.resize(nodes.size(), false);
+			removedNodes[idNode] = true;
+			changes.removedNodes.push_back(idNode);
+		}
+		else if(op.type == DiffOperation::ADD_EDGE){
+			int o = findNode(op.origin), d = findNode(op.dest);
+			if(o == -1 || d == -1)
+				continue;
+			int r = findRoad(op.id);
+			changes.addedEdges.push_back(edges.size());
+			edges.push_back(pair<int,int>(o, d));
+			weightOfEdges.push_back(pair<double,bool>(dist(nodes[o], nodes[d]), r != -1 && roads[r].second.second));
+			mapIdEdgeToIdRoad.push_back(op.id);
+			addIncidentEdge(edges.size() - 1);
+		}
+		else if(op.type == DiffOperation::REMOVE_EDGE || op.type == DiffOperation::SET_WEIGHT){
+			int e = findEdge(op.id, findNode(op.origin), findNode(op.dest));
+			if(e == -1)
+				continue;
+			if(op.type == DiffOperation::REMOVE_EDGE)
+				removeEdge(e, changes);
+			else{
+				weightOfEdges[e].first = op.weight;
+				changes.reweightedEdges.push_back(e);
+			}
+		}
+		else if(op.type == DiffOperation::SET_ROAD){
+			int r = findRoad(op.id);
+			bool wasTwoWay = (r != -1 && roads[r].second.second);
+			uint32_t name = roadNames.intern(op.name);
+			if(r == -1)
+				roads.insert(lower_bound(roads.begin(), roads.end(), op.id, id_less_than<pair<uint32_t,bool> >()),
+						make_pair(op.id, pair<uint32_t,bool>(name, op.twoWay)));
+			else
+				roads[r].second = pair<uint32_t,bool>(name, op.twoWay);
+			if(wasTwoWay == op.twoWay)
+				continue;
+			vector<pair<ll,bool> >::iterator it = lower_bound(redirectedRoads.begin(), redirectedRoads.end(), op.id, id_less_than<bool>());
+			if(it != redirectedRoads.end() && it->first == op.id)
+				it->second = op.twoWay;
+			else
+				redirectedRoads.insert(it, make_pair(op.id, op.twoWay));
+		}
+	}
+
+	if(!redirectedRoads.empty())
+		for(size_t e = 0;e < edges.size();e++){
+			int r = findById(redirectedRoads, mapIdEdgeToIdRoad[e]);
+			if(r != -1 && !isEdgeRemoved(e) && weightOfEdges[e].second != redirectedRoads[r].second){
+				weightOfEdges[e].second = redirectedRoads[r].second;
+				changes.redirectedEdges.push_back(e);
+			}
+		}
+	return changes;
+}
+
+/**
+ * Position of (x, y) along a Hilbert curve over a 2^16 x 2^16 grid.
+ */
+static ll hilbertIndex(unsigned x, unsigned y){
+	ll d = 0;
+	for(unsigned s = 1 << 15;s > 0;s /= 2){
+		unsigned rx = (x & s) > 0;
+		unsigned ry = (y & s) > 0;
+		d += (ll)s * s * ((3 * rx) ^ ry);
+		if(ry == 0){
+			if(rx == 1){
+				x = s - 1 - (x & (s - 1));
+				y = s - 1 - (y & (s - 1));
+			}
+			swap(x, y);
+		}
+	}
+	return d;
+}
+
+/**
+ * Nodes sorted by their position on the Hilbert curve, file order breaking ties.
+ */
+static vector<int> hilbertOrder(const vector<pair<double,double> >& nodes){
+	vector<pair<ll,int> > keys(nodes.size());
+	if(nodes.empty())
+		return vector<int>();
+	double minX = nodes[0].first, maxX = minX, minY = nodes[0].second, maxY = minY;
+	for(size_t i = 1;i < nodes.size();i++){
+		minX = min(minX, nodes[i].first); maxX = max(maxX, nodes[i].first);
+		minY = min(minY, nodes[i].second); maxY = max(maxY, nodes[i].second);
+	}
+	double side = max(max(maxX - minX, maxY - minY), 1e-9);
+	for(size_t i = 0;i < nodes.size();i++){
+		unsigned x = (unsigned)((nodes[i].first - minX) / side * 65535);
+		unsigned y = (unsigned)((nodes[i].second - minY) / side * 65535);
+		keys[i] = pair<ll,int>(hilbertIndex(x, y), i);
+	}
+	sort(keys.begin(), keys.end());
+	vector<int> order(nodes.size());
+	for(size_t i = 0;i < keys.size();i++)
+		order[i] = keys[i].second;
+	return order;
+}
+
+struct degree_less_than {
+	const vector<int>& degree;
+	degree_less_than(const vector<int>& degree): degree(degree) {}
+	bool operator()(int a, int b) const { return degree[a] < degree[b]; }
+};
+
+/**
+ * Reverse Cuthill-McKee order of the graph without directions: each component
+ * is visited breadth-first from one of its nodes of lowest degree, neighbours
+ * by increasing degree, and the whole order is reversed.
+ */
+static vector<int> rcmOrder(int V, const vector<pair<int,int> >& edges, const vector<bool>& removed){
+	vector<int> degree(V, 0);
+	for(size_t i = 0;i < edges.size();i++)
+		if(!(i < removed.size() && removed[i]) && edges[i].first != edges[i].second){
+			degree[edges[i].first]++;
+			degree[edges[i].second]++;
+		}
+	vector<int> first(V + 1, 0);
+	for(int v = 0;v < V;v++)
+		first[v+1] = first[v] + degree[v];
+	vector<int> neighbours(first[V]);
+	vector<int> cursor(first.begin(), first.end() - 1);
+	for(size_t i = 0;i < edges.size();i++)
+		if(!(i < removed.size() && removed[i]) && edges[i].first != edges[i].second){
+			neighbours[cursor[edges[i].first]++] = edges[i].second;
+			neighbours[cursor[edges[i].second]++] = edges[i].first;
+		}
+
+	vector<int> byDegree(V);
+	for(int v = 0;v < V;v++)
+		byDegree[v] = v;
+	stable_sort(byDegree.begin(), byDegree.end(), degree_less_than(degree));
+
+	vector<int> order;
+	vector<bool> visited(V, false);
+	order.reserve(V);
+	for(int k = 0;k < V;k++){
+		int start = byDegree[k];
+		if(visited[start])
+			continue;
+		visited[start] = true;
+		order.push_back(start);
+		for(size_t head = order.size() - 1;head < order.size();head++){
+			int v = order[head];
+			size_t begin = order.size();
+			for(int j = first[v];j < first[v+1];j++)
+				if(!visited[neighbours[j]]){
+					visited[neighbours[j]] = true;
+					order.push_back(neighbours[j]);
+				}
+			stable_sort(order.begin() + begin, order.end(), degree_less_than(degree));
+		}
+	}
+	reverse(order.begin(), order.end());
+	return order;
+}
+
+/**
+ * Renumbers the nodes in the given order, to make graph traversals touch memory
+ * in order. Every table that refers to nodes is renumbered; edge ids do not change.
+ * Graphs, indexes and routes built before must be built again.
+ * toFileOrder and fromFileOrder convert ids to and from the order of nodes.txt.
+ */
+void MapReading::reorderNodes(NodeOrder order){
+	int V = nodes.size();
+	vector<int> oldOfNew = (order == HILBERT_ORDER) ? hilbertOrder(nodes) : rcmOrder(V, edges, removedEdges);
+	vector<int> newOfOld(V);
+	for(int i = 0;i < V;i++)
+		newOfOld[oldOfNew[i]] = i;
+
+	vector<pair<double,double> > newNodes(V);
+	vector<string> newNames(V);
+	for(int i = 0;i < V;i++){
+		newNodes[i] = nodes[oldOfNew[i]];
+		newNames[i].swap(nameOfNodes[oldOfNew[i]]);
+	}
+	nodes.swap(newNodes);
+	nameOfNodes.swap(newNames);
+	if(!removedNodes.empty()){
+		vector<bool> newRemoved(V, false);
+		for(int i = 0;i < V;i++)
+			newRemoved[i] = isNodeRemoved(oldOfNew[i]);
+		removedNodes.swap(newRemoved);
+	}
+	edgesOfNode.clear();
+	for(size_t i = 0;i < mapNodes.size();i++)
+		mapNodes[i].second = newOfOld[mapNodes[i].second];
+	for(size_t i = 0;i < edges.size();i++){
+		edges[i].first = newOfOld[edges[i].first];
+		edges[i].second = newOfOld[edges[i].second];
+	}
+
+	if(fileOrderOfNode.empty()){
+		fileOrderOfNode = oldOfNew;
+		nodeOfFileOrder = newOfOld;
+	}
+	else{
+		vector<int> fileOrder(V);
+		for(int i = 0;i < V;i++){
+			fileOrder[i] = fileOrderOfNode[oldOfNew[i]];
+			nodeOfFileOrder[fileOrder[i]] = i;
+		}
+		fileOrderOfNode.swap(fileOrder);
+	}
+}
+
+/**
+ * Id the node had before any reorderNodes (its position in nodes.txt).
+ */
+int MapReading::toFileOrder(int idNode) const {
+	return fileOrderOfNode.empty() ? idNode : fileOrderOfNode[idNode];
+}
+
+int MapReading::fromFileOrder(int idNode) const {
+	return nodeOfFileOrder.empty() ? idNode : nodeOfFileOrder[idNode];
+}
+
+/**
+ * Updates a graph made by getGraph after applyDiff, changing only the edges in changes.
+ * Its Floyd-Warshall matrices must be computed again if they are used.
+ */
+void MapReading::applyChanges(const MapChanges& changes, Graph<int>& g) const {
+	for(size_t i = 0;i < changes.addedNodes.size();i++)
+		g.addVertex(changes.addedNodes[i]);
+
+	vector<int> changed = changes.getChangedEdges();
+	for(size_t i = 0;i < changed.size();i++){
+		int e = changed[i];
+		g.removeEdgesWithId(edges[e].first, e);
+		g.removeEdgesWithId(edges[e].second, e);
+		if(isEdgeRemoved(e))
+			continue;
+		g.addEdge(edges[e].first, edges[e].second, weightOfEdges[e].first, e);
+		if(weightOfEdges[e].second)
+			g.addEdge(edges[e].second, edges[e].first, weightOfEdges[e].first, e);
+	}
+}
+
+/**
+ * Updates a graph made by getCompactGraph after applyDiff. New weights are written
+ * in place; any other change builds the graph again.
+ */
+void MapReading::applyChanges(const MapChanges& changes, CompactGraph& g) const {
+	if(changes.affectsTopology()){
+		g = getCompactGraph();
+		return;
+	}
+	for(size_t i = 0;i < changes.reweightedEdges.size();i++){
+		int e = changes.reweightedEdges[i];
+		g.setEdgeWeight(edges[e].first, e, weightOfEdges[e].first);
+		g.setEdgeWeight(edges[e].second, e, weightOfEdges[e].first);
+	}
+}
+
+/**
+ * Turns the OSM ids of the edges into dense node ids and computes their weights.
+ * Only reads the nodes and roads, so several chunks can be resolved at the same time.
+ * Edges whose nodes are not in nodes.txt get o = -1 and are dropped by mergeEdges.
+ */
+void MapReading::resolveEdges(EdgesChunk& chunk) const {
+	size_t n = chunk.idRoads.size();
+	chunk.o.resize(n);
+	chunk.d.resize(n);
+	chunk.weights.resize(n);
+	chunk.twoWay.resize(n);
+	for(size_t i = 0;i < n;i++){
+		int o = findNode(chunk.origins[i]);
+		int d = findNode(chunk.dests[i]);
+		chunk.o[i] = (d == -1) ? -1 : o;
+		if(chunk.o[i] == -1)
+			continue;
+		chunk.d[i] = d;
+		chunk.weights[i] = dist(nodes[o], nodes[d]);
+		int r = findRoad(chunk.idRoads[i]);
+		chunk.twoWay[i] = (r != -1 && roads[r].second.second);
+	}
+}
+
+void MapReading::mergeEdges(const EdgesChunk& chunk){
+	for(size_t i = 0;i < chunk.idRoads.size();i++){
+		if(chunk.o[i] == -1)
+			continue;
+		mapIdEdgeToIdRoad.push_back(chunk.idRoads[i]);
+		edges.push_back(pair<int,int>(chunk.o[i],chunk.d[i]));
+		weightOfEdges.push_back(pair<double,bool>(chunk.weights[i],chunk.twoWay[i]));
+	}
+}
+
+/**
+ * Reads the three map files. Each file is memory-mapped and split in chunks of whole
+ * lines, and the chunks of all three files are parsed at the same time on the
+ * default thread pool. The results are merged in file order, so node and edge ids
+ * are the same as with a sequential read. Edge endpoints are resolved only after
+ * every node has been merged.
+ */
 void MapReading::readMap(string nodesFlName, string roadsFlName, string edgesFlName){
-	ifstream ifsNodes(nodesFlName.c_str());
-	ifstream ifsRoads(roadsFlName.c_str());
-	ifstream ifsEdges(edgesFlName.c_str());
+	MappedFile nodesFl, roadsFl, edgesFl;
 
-	if(ifsNodes.is_open() == false)
+	if(nodesFl.open(nodesFlName) == false)
 		throw FileNotExists("nodes.txt");
-	if(ifsRoads.is_open() == false)
+	if(roadsFl.open(roadsFlName) == false)
 		throw FileNotExists("roads.txt");
-	if(ifsEdges.is_open() == false)
+	if(edgesFl.open(edgesFlName) == false)
 		throw FileNotExists("edges.txt");
 
-	readRoadsFromFile(ifsRoads);
-	readNodesFromFile(ifsNodes);
-	readEdgesFromFile(ifsEdges);
+	ThreadPool& pool = ThreadPool::getDefault();
+	vector<Range> roadRanges = splitInLines(roadsFl.begin(), roadsFl.end(), pool.size());
+	vector<Range> nodeRanges = splitInLines(nodesFl.begin(), nodesFl.end(), pool.size());
+	vector<Range> edgeRanges = splitInLines(edgesFl.begin(), edgesFl.end(), pool.size());
+	vector<RoadsChunk> roadChunks(roadRanges.size());
+	vector<NodesChunk> nodeChunks(nodeRanges.size());
+	vector<EdgesChunk> edgeChunks(edgeRanges.size());
+
+	vector<future<void> > tasks;
+	for(size_t i = 0;i < roadRanges.size();i++)
+		tasks.push_back(pool.submit([&, i](){ parseRoads(roadRanges[i].first, roadRanges[i].second, roadChunks[i]); }));
+	for(size_t i = 0;i < nodeRanges.size();i++)
+		tasks.push_back(pool.submit([&, i](){ parseNodes(nodeRanges[i].first, nodeRanges[i].second, nodeChunks[i]); }));
+	for(size_t i = 0;i < edgeRanges.size();i++)
+		tasks.push_back(pool.submit([&, i](){ parseEdges(edgeRanges[i].first, edgeRanges[i].second, edgeChunks[i]); }));
+	ThreadPool::waitAll(tasks);
 
-	ifsNodes.close();
-	ifsRoads.close();
-	ifsEdges.close();
+	for(size_t i = 0;i < roadChunks.size();i++)
+		mergeRoads(roadChunks[i]);
+	indexRoads();
+	for(size_t i = 0;i < nodeChunks.size();i++)
+		mergeNodes(nodeChunks[i]);
+	indexNodes();
+
+	for(size_t i = 0;i < edgeChunks.size();i++)
+		tasks.push_back(pool.submit([&, i](){ resolveEdges(edgeChunks[i]); }));
+	ThreadPool::waitAll(tasks);
+	for(size_t i = 0;i < edgeChunks.size();i++)
+		mergeEdges(edgeChunks[i]);
 }
 
-void MapReading::readRoadsFromFile(ifstream& ifs){
-	string roadName;
-	ll idRoad;
-	char pontoVirgula;
-
-	while(1){
-		ifs >> idRoad >> pontoVirgula;
-		if(ifs.eof())
-			break;
-		roadName = "";
-		char c;
-		bool isTwoWay;
-		ifs >> c;
-		while(c != ';'){
-			roadName += c;
-			ifs >> c;
-		}
-		string s;
-		ifs >> s;
-		if(s == "True")
-			isTwoWay = true;
-		else
-			isTwoWay = false;
-		roads[idRoad] = pair<string,bool>(roadName,isTwoWay);
-	}
+void MapReading::readRoadsFromBuffer(const char* begin, const char* end){
+	RoadsChunk chunk;
+	parseRoads(begin, end, chunk);
+	mergeRoads(chunk);
+	indexRoads();
 }
 
-void MapReading::readNodesFromFile(ifstream& ifs){
-	ll idNodeLong;
-	char pontoVirgula;
-	double longRad, latRad, lixo;
-	int idNode = 0;
+void MapReading::readNodesFromBuffer(const char* begin, const char* end){
+	NodesChunk chunk;
+	parseNodes(begin, end, chunk);
+	mergeNodes(chunk);
+	indexNodes();
+}
+
+/**
+ * Edges whose nodes are not in nodes.txt are ignored.
+ */
+void MapReading::readEdgesFromBuffer(const char* begin, const char* end){
+	EdgesChunk chunk;
+	parseEdges(begin, end, chunk);
+	resolveEdges(chunk);
+	mergeEdges(chunk);
+}
+
+/**
+ * Copies the next count elements of type V out of the mapped file.
+ */
+template <class V>
+static const char* readArray(const char* p, vector<V>& out, size_t count){
+	out.resize(count);
+	if(count > 0)
+		memcpy(&out[0], p, count*sizeof(V));
+	return p + count*sizeof(V);
+}
+
+template <class V>
+static void writeArray(ofstream& ofs, const vector<V>& in){
+	if(!in.empty())
+		ofs.write((const char*) &in[0], in.size()*sizeof(V));
+}
+
+/**
+ * Loads a map written by writeBinaryMap (see BinaryMapFormat.h). The coordinates
+ * are already projected, so loading is a copy of each section. Throws
+ * InvalidMapFormat if the file is truncated or its sections are inconsistent.
+ */
+void MapReading::readBinaryMap(string binaryFlName){
+	MappedFile fl;
+	if(fl.open(binaryFlName) == false)
+		throw FileNotExists(binaryFlName);
+
+	BinaryMapHeader header;
+	if(fl.size() < sizeof(header))
+		throw InvalidMapFormat(binaryFlName, "file too small");
+	memcpy(&header, fl.begin(), sizeof(header));
+	if(memcmp(header.magic, BINARY_MAP_MAGIC, 4) != 0)
+		throw InvalidMapFormat(binaryFlName, "not a binary map");
+	if(header.version != BINARY_MAP_VERSION)
+		throw InvalidMapFormat(binaryFlName, "unsupported version");
+
+	size_t V = header.numNodes, E = header.numEdges, R = header.numRoads;
+	size_t expected = sizeof(header) + V*(8+8+8) + E*(4+4+8+8+1) + R*(8+4+1) + 4 + header.stringTableSize;
+	if(fl.size() != expected)
+		throw InvalidMapFormat(binaryFlName, "truncated file");
+
+	vector<int64_t> osmIds, roadOfEdge, idRoads;
+	vector<double> x, y, weight;
+	vector<int32_t> origin, dest;
+	vector<uint8_t> twoWay, roadTwoWay;
+	vector<uint32_t> nameOffset;
+
+	const char* p = fl.begin() + sizeof(header);
+	p = readArray(p, osmIds, V);
+	p = readArray(p, x, V);
+	p = readArray(p, y, V);
+	p = readArray(p, origin, E);
+	p = readArray(p, dest, E);
+	p = readArray(p, weight, E);
+	p = readArray(p, roadOfEdge, E);
+	p = readArray(p, twoWay, E);
+	p = readArray(p, idRoads, R);
+	p = readArray(p, nameOffset, R+1);
+	p = readArray(p, roadTwoWay, R);
+	const char* strings = p;
+
+	for(size_t i = 0;i < E;i++)
+		if(origin[i] < 0 || (size_t)origin[i] >= V || dest[i] < 0 || (size_t)dest[i] >= V)
+			throw InvalidMapFormat(binaryFlName, "edge with an invalid node");
+	for(size_t i = 1;i < R;i++)
+		if(idRoads[i] < idRoads[i-1])
+			throw InvalidMapFormat(binaryFlName, "roads not sorted by id");
+	for(size_t i = 0;i < R;i++)
+		if(nameOffset[i] > nameOffset[i+1])
+			throw InvalidMapFormat(binaryFlName, "invalid road name offsets");
+	if(nameOffset[R] > header.stringTableSize)
+		throw InvalidMapFormat(binaryFlName, "invalid road name offsets");
 
-	while( 1 ) {
-		ifs >> idNodeLong >> pontoVirgula >> lixo >> pontoVirgula >> lixo >> pontoVirgula >> longRad >> pontoVirgula >> latRad;
-		if(ifs.eof())
-			break;
-		mapNodes[idNodeLong] = idNode;
-		nodes[idNode] = pair<double,double>(cos(latRad)*cos(longRad)*6371000,cos(latRad)*sin(longRad)*6371000);
-		idNode++;
+	roads.resize(R);
+	for(size_t i = 0;i < R;i++)
+		roads[i] = make_pair(idRoads[i], pair<uint32_t,bool>(roadNames.intern(strings + nameOffset[i], strings + nameOffset[i+1]), roadTwoWay[i] != 0));
+	nodes.resize(V);
+	mapNodes.resize(V);
+	nameOfNodes.assign(V, "");
+	for(size_t i = 0;i < V;i++){
+		mapNodes[i] = pair<ll,int>(osmIds[i], i);
+		nodes[i] = pair<double,double>(x[i], y[i]);
+	}
+	indexNodes();
+	mapIdEdgeToIdRoad.assign(roadOfEdge.begin(), roadOfEdge.end());
+	edges.resize(E);
+	weightOfEdges.resize(E);
+	for(size_t i = 0;i < E;i++){
+		edges[i] = pair<int,int>(origin[i], dest[i]);
+		weightOfEdges[i] = pair<double,bool>(weight[i], twoWay[i] != 0);
 	}
 }
 
-void MapReading::readEdgesFromFile(ifstream& ifs){
-	char pontoVirgula;
-	ll idRoad;
-	int idEdge = 0;
-	ll origin, dest;
+/**
+ * Saves the map in the binary format of BinaryMapFormat.h. Nodes and edges
+ * removed by a diff are left out, so the ones after them get new ids.
+ */
+void MapReading::writeBinaryMap(string binaryFlName){
+	ofstream ofs(binaryFlName.c_str(), ios::binary);
+	if(ofs.is_open() == false)
+		throw FileNotExists(binaryFlName);
 
-	while( 1 ) {
-		ifs >> idRoad >> pontoVirgula >> origin >> pontoVirgula >> dest >> pontoVirgula;
-		if(ifs.eof())
-			break;
-		int o = mapNodes[origin];
-		int d = mapNodes[dest];
-		mapIdEdgeToIdRoad[idEdge] = idRoad;
-		edges[idEdge] = pair<int,int>(o,d);
+	vector<int> active;
+	for(size_t i = 0;i < edges.size();i++)
+		if(!isEdgeRemoved(i))
+			active.push_back(i);
+	vector<int> liveNodes, newIdOfNode(nodes.size(), -1);
+	for(size_t i = 0;i < nodes.size();i++)
+		if(!isNodeRemoved(i)){
+			newIdOfNode[i] = liveNodes.size();
+			liveNodes.push_back(i);
+		}
+
+	size_t V = liveNodes.size(), E = active.size(), R = roads.size();
+	vector<int64_t> osmIds(V), roadOfEdge(E), idRoads;
+	vector<double> x(V), y(V), weight(E);
+	vector<int32_t> origin(E), dest(E);
+	vector<uint8_t> twoWay(E), roadTwoWay;
+	vector<uint32_t> nameOffset;
+	string strings;
 
-		double weight = dist(nodes[o], nodes[d]);
-		weightOfEdges[idEdge] = pair<double,bool>(weight,roads[idRoad].second);
-		idEdge++;
+	for(size_t i = 0;i < mapNodes.size();i++)
+		osmIds[newIdOfNode[mapNodes[i].second]] = mapNodes[i].first;
+	for(size_t i = 0;i < V;i++){
+		x[i] = nodes[liveNodes[i]].first;
+		y[i] = nodes[liveNodes[i]].second;
+	}
+	for(size_t i = 0;i < E;i++){
+		origin[i] = newIdOfNode[edges[active[i]].first];
+		dest[i] = newIdOfNode[edges[active[i]].second];
+		weight[i] = weightOfEdges[active[i]].first;
+		twoWay[i] = weightOfEdges[active[i]].second;
+		roadOfEdge[i] = mapIdEdgeToIdRoad[active[i]];
 	}
+	for(size_t i = 0;i < R;i++){
+		idRoads.push_back(roads[i].first);
+		nameOffset.push_back(strings.size());
+		strings.append(roadNames.data(roads[i].second.first), roadNames.length(roads[i].second.first));
+		roadTwoWay.push_back(roads[i].second.second);
+	}
+	nameOffset.push_back(strings.size());
+
+	BinaryMapHeader header;
+	memcpy(header.magic, BINARY_MAP_MAGIC, 4);
+	header.version = BINARY_MAP_VERSION;
+	header.numNodes = V;
+	header.numEdges = E;
+	header.numRoads = R;
+	header.stringTableSize = strings.size();
+	ofs.write((const char*) &header, sizeof(header));
+
+	writeArray(ofs, osmIds);
+	writeArray(ofs, x);
+	writeArray(ofs, y);
+	writeArray(ofs, origin);
+	writeArray(ofs, dest);
+	writeArray(ofs, weight);
+	writeArray(ofs, roadOfEdge);
+	writeArray(ofs, twoWay);
+	writeArray(ofs, idRoads);
+	writeArray(ofs, nameOffset);
+	writeArray(ofs, roadTwoWay);
+	ofs.write(strings.data(), strings.size());
+	ofs.close();
 }
 
+/**
+ * Reads the optional travel-time profiles of the edges. Must be called after readMap,
+ * since the profiles refer to the edge ids given while reading edges.txt.
+ */
+void MapReading::readTravelTimeProfiles(string profilesFlName){
+	ifstream ifs(profilesFlName.c_str());
+	if(ifs.is_open() == false)
+		throw FileNotExists(profilesFlName);
+
+	profiles.readFromFile(ifs);
+	profiles.setNumEdges(edges.size());
+	ifs.close();
+}
+
+const TravelTimeProfiles& MapReading::getTravelTimeProfiles() const {
+	return profiles;
+}
+
+/**
+ * Sends the nodes and edges to the viewer. When gv is in batching mode the
+ * commands go out in large chunks and are flushed before returning.
+ */
 void MapReading::sendDataToGraphViewer(GraphViewer *gv){
 	double minX = LLONG_MAX;
 	double minY = LLONG_MAX;
@@ -99,28 +858,35 @@ void MapReading::sendDataToGraphViewer(GraphViewer *gv){
 	double maxY = LLONG_MIN;
 
 	for(size_t i = 0;i < nodes.size();i++){
+		if(isNodeRemoved(i))
+			continue;
 		minX = min(minX, nodes[i].first);
 		minY = min(minY, nodes[i].second);
 		maxX = max(maxX, nodes[i].first);
 		maxY = max(maxY, nodes[i].second);
 	}
+	gv->defineVertexSize(5);
 	for(size_t i = 0;i < nodes.size();i++){
+		if(isNodeRemoved(i))
+			continue;
 		double x, y;
 		x = nodes[i].first;
 		y = nodes[i].second;
 		gv->addNode(i, (x-minX)/(maxX-minX)*850 + 25, (y-minY)/(maxY-minY)*550 + 25);
-		gv->setVertexSize(i, 5);
 	}
 	for(size_t i = 0;i < edges.size();i++){
 		int o = edges[i].first;
 		int d = edges[i].second;
 
+		if(isEdgeRemoved(i))
+			continue;
 		if(weightOfEdges[i].second == true)
 			gv->addEdge(i, o, d, EdgeType::UNDIRECTED);
 		else
 			gv->addEdge(i, o, d, EdgeType::DIRECTED);
 		gv->setEdgeFlow(i, weightOfEdges[i].first);
 	}
+	gv->flush();
 }
 
 Graph<int> MapReading::getGraph(){
@@ -128,20 +894,62 @@ Graph<int> MapReading::getGraph(){
 	for(unsigned int i = 0;i < nodes.size();i++)
 		g.addVertex(i);
 	for(unsigned int i = 0;i < edges.size();i++)
-		if(weightOfEdges[i].second == true){
-			g.addEdge(edges[i].first, edges[i].second, weightOfEdges[i].first);
-			g.addEdge(edges[i].second, edges[i].first, weightOfEdges[i].first);
+		if(isEdgeRemoved(i))
+			continue;
+		else if(weightOfEdges[i].second == true){
+			g.addEdge(edges[i].first, edges[i].second, weightOfEdges[i].first, i);
+			g.addEdge(edges[i].second, edges[i].first, weightOfEdges[i].first, i);
 		}
 		else
-			g.addEdge(edges[i].first, edges[i].second, weightOfEdges[i].first);
+			g.addEdge(edges[i].first, edges[i].second, weightOfEdges[i].first, i);
 	return g;
 }
 
-map<int, pair<int,int> >& MapReading::getEdges(){
+/**
+ * Same graph as getGraph, built directly from the edge arrays in compressed form.
+ */
+CompactGraph MapReading::getCompactGraph() const {
+	return CompactGraph(nodes.size(), edges, weightOfEdges, removedEdges);
+}
+
+/**
+ * Index over the coordinates of the nodes not removed by a diff. Locations
+ * given in degrees must be converted with project before querying it.
+ */
+SpatialIndex MapReading::getSpatialIndex() const {
+	return SpatialIndex(nodes, removedNodes);
+}
+
+/**
+ * Index of the edges by their end nodes, both ways for two-way roads.
+ */
+EdgeIndex MapReading::getEdgeIndex() const {
+	return EdgeIndex(edges, weightOfEdges, removedEdges);
+}
+
+/**
+ * Level of detail for showing only part of the map in a width x height window.
+ */
+ViewportStreamer MapReading::getViewportStreamer(int width, int height, size_t maxNodes) const {
+	return ViewportStreamer(nodes, removedNodes, edges, weightOfEdges, removedEdges, mapIdEdgeToIdRoad, width, height, maxNodes);
+}
+
+/**
+ * Coordinates in the plane of the nodes of a point given in degrees.
+ */
+pair<double,double> MapReading::project(double latDeg, double longDeg){
+	return projectRadians(latDeg*M_PI/180, longDeg*M_PI/180);
+}
+
+pair<double,double> MapReading::projectRadians(double latRad, double longRad){
+	return pair<double,double>(cos(latRad)*cos(longRad)*6371000,cos(latRad)*sin(longRad)*6371000);
+}
+
+vector<pair<int,int> >& MapReading::getEdges(){
 	return edges;
 }
 
-map<int, pair<double, bool> >& MapReading::getEdgesProperties(){
+vector<pair<double, bool> >& MapReading::getEdgesProperties(){
 	return weightOfEdges;
 }
 
@@ -165,17 +973,25 @@ void MapReading::sendDataToGraphViewerManual(GraphViewer *gv){
 
 		gv->setEdgeFlow(i, weightOfEdges[i].first);
 	}
+	gv->flush();
 }
 
 void MapReading::sendVertexLabelsToGraphViewer(GraphViewer *gv){
 	for(size_t i = 0;i < nodes.size();i++){
 		gv->setVertexLabel(i, nameOfNodes[i]);
 	}
+	gv->flush();
 }
 
 void MapReading::makeManualGraph(){
 	int startX = 50, startY = 300, dist = 100;
 
+	nodes.resize(20);
+	nameOfNodes.resize(20);
+	edges.resize(24);
+	weightOfEdges.resize(24);
+	mapIdEdgeToIdRoad.assign(24, 0);
+
 	nodes[0] = pair<double,double>(startX,startY);
 	nodes[1] = pair<double,double>(startX+dist,startY-dist);
 	nodes[2] = pair<double,double>(startX+2*dist,startY-2*dist);
@@ -261,11 +1077,11 @@ void MapReading::makeManualGraph(){
 	weightOfEdges[23] = pair<double,bool>(18,true);
 }
 
-map<int, string> MapReading::getNameOfNodes(){
+const vector<string>& MapReading::getNameOfNodes() const {
 	return nameOfNodes;
 }
 
-map<int, pair<double,double> > MapReading::getNodes(){
+const vector<pair<double,double> >& MapReading::getNodes() const {
 	return nodes;
 }
 
@@ -1,46 +1,107 @@
 #ifndef SRC_MAPREADING_H_
 #define SRC_MAPREADING_H_
 
-#include <map>
+#include <vector>
 #include <iostream>
 #include <fstream>
 #include <climits>
 #include "Graph.h"
 #include "graphviewer.h"
 #include "FileNotExists.h"
+#include "TravelTimeProfiles.h"
+#include "CompactGraph.h"
+#include "SpatialIndex.h"
+#include "EdgeIndex.h"
+#include "ViewportStreamer.h"
+#include "StringPool.h"
+#include "MapDiff.h"
+#include "MappedFile.h"
 
 using namespace std;
 
 typedef long long int ll;
 
+/**
+ * Orders for MapReading::reorderNodes.
+ * HILBERT_ORDER: along a Hilbert curve over the coordinates, so that nodes close in the map are close in memory.
+ * RCM_ORDER: reverse Cuthill-McKee, a breadth-first order that keeps the neighbours of each node close.
+ */
+enum NodeOrder { HILBERT_ORDER, RCM_ORDER };
+
 class MapReading {
 
 private:
-	map<ll, int> mapNodes;
-	map<int, ll> mapIdEdgeToIdRoad;
-	map<ll, pair<string, bool> > roads;
-	map<int, pair<double,double> > nodes;
-	map<int, pair<int,int> > edges;
-	map<int,pair<double,bool> > weightOfEdges;
-	map<int, string> nameOfNodes;
+	vector<pair<ll, int> > mapNodes;					//sorted by OSM id
+	vector<ll> mapIdEdgeToIdRoad;
+	vector<pair<ll, pair<uint32_t, bool> > > roads;	//sorted by road id: name in roadNames, two-way
+	StringPool roadNames;
+	vector<pair<double,double> > nodes;
+	vector<pair<int,int> > edges;
+	vector<pair<double,bool> > weightOfEdges;
+	vector<bool> removedEdges;				//set by applyDiff, shorter than edges when the last ones were never removed
+	vector<bool> removedNodes;				//same for nodes
+	vector<vector<int> > edgesOfNode;		//incident edges in id order, built by the first applyDiff
+	vector<string> nameOfNodes;
+	vector<int> fileOrderOfNode;			//node id before reorderNodes, empty if never reordered
+	vector<int> nodeOfFileOrder;
+	TravelTimeProfiles profiles;
+
+	void indexNodes();
+	void indexRoads();
+	int findEdge(ll idRoad, int origin, int dest) const;
+	void removeEdge(int idEdge, MapChanges& changes);
+	void indexIncidentEdges();
+	void addIncidentEdge(int idEdge);
+
+	struct RoadsChunk;
+	struct NodesChunk;
+	struct EdgesChunk;
+	static void parseRoads(const char* begin, const char* end, RoadsChunk& chunk);
+	static void parseNodes(const char* begin, const char* end, NodesChunk& chunk);
+	static void parseEdges(const char* begin, const char* end, EdgesChunk& chunk);
+	void mergeRoads(const RoadsChunk& chunk);
+	void mergeNodes(const NodesChunk& chunk);
+	void resolveEdges(EdgesChunk& chunk) const;
+	void mergeEdges(const EdgesChunk& chunk);
 
 public:
 	MapReading(){};
 	virtual ~MapReading(){};
 
 	void readMap(string nodesFlName, string roadsFlName, string edgesFlName);
-	void readEdgesFromFile(ifstream& ifs);		//EDGES
-	void readNodesFromFile(ifstream& ifs);		//NODES
-	void readRoadsFromFile(ifstream& ifs);		//ROADS
-	map<int, pair<int,int> >& getEdges();
-	map<int, pair<double, bool> >& getEdgesProperties();
+	void readEdgesFromBuffer(const char* begin, const char* end);		//EDGES
+	void readNodesFromBuffer(const char* begin, const char* end);		//NODES
+	void readRoadsFromBuffer(const char* begin, const char* end);		//ROADS
+	void readBinaryMap(string binaryFlName);
+	void writeBinaryMap(string binaryFlName);
+	void readTravelTimeProfiles(string profilesFlName);
+	const TravelTimeProfiles& getTravelTimeProfiles() const;
+	int findNode(ll idNode) const;
+	int findRoad(ll idRoad) const;
+	string getRoadName(int idEdge) const;
+	bool isEdgeRemoved(int idEdge) const;
+	bool isNodeRemoved(int idNode) const;
+	MapChanges applyDiff(const MapDiff& diff);
+	void applyChanges(const MapChanges& changes, Graph<int>& g) const;
+	void applyChanges(const MapChanges& changes, CompactGraph& g) const;
+	void reorderNodes(NodeOrder order);
+	int toFileOrder(int idNode) const;
+	int fromFileOrder(int idNode) const;
+	vector<pair<int,int> >& getEdges();
+	vector<pair<double, bool> >& getEdgesProperties();
 	void sendDataToGraphViewer(GraphViewer *gv);
 	void sendDataToGraphViewerManual(GraphViewer *gv);
 	void sendVertexLabelsToGraphViewer(GraphViewer *gv);
 	Graph<int> getGraph();
+	CompactGraph getCompactGraph() const;
+	SpatialIndex getSpatialIndex() const;
+	EdgeIndex getEdgeIndex() const;
+	ViewportStreamer getViewportStreamer(int width, int height, size_t maxNodes = ViewportStreamer::DEFAULT_MAX_NODES) const;
+	static pair<double,double> project(double latDeg, double longDeg);
+	static pair<double,double> projectRadians(double latRad, double longRad);
 	void makeManualGraph();
-	map<int, string> getNameOfNodes();
-	map<int, pair<double,double> > getNodes();
+	const vector<string>& getNameOfNodes() const;
+	const vector<pair<double,double> >& getNodes() const;
 };
 
 #endif /* SRC_MAPREADING_H_ */
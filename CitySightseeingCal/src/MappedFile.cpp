@@ -0,0 +1,100 @@
+/*
+ * MappedFile.cpp
+ */
+
+#include "MappedFile.h"
+
+#ifdef linux
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#ifdef linux
+MappedFile::MappedFile(): data(NULL), length(0), fd(-1) {}
+#else
+MappedFile::MappedFile(): data(NULL), length(0), file(INVALID_HANDLE_VALUE), mapping(NULL) {}
+#endif
+
+MappedFile::~MappedFile(){
+	close();
+}
+
+/**
+ * Maps the file. Returns false if it cannot be opened. An empty file is
+ * opened successfully with begin() == end().
+ */
+bool MappedFile::open(const string& flName){
+	close();
+#ifdef linux
+	fd = ::open(flName.c_str(), O_RDONLY);
+	if(fd < 0)
+		return false;
+	struct stat st;
+	if(fstat(fd, &st) < 0){
+		close();
+		return false;
+	}
+	length = st.st_size;
+	if(length == 0){
+		data = "";
+		return true;
+	}
+	void* p = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+	if(p == MAP_FAILED){
+		close();
+		return false;
+	}
+	madvise(p, length, MADV_SEQUENTIAL);
+	data = (const char*) p;
+#else
+	file = CreateFileA(flName.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+			FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if(file == INVALID_HANDLE_VALUE)
+		return false;
+	LARGE_INTEGER fileSize;
+	GetFileSizeEx(file, &fileSize);
+	length = fileSize.QuadPart;
+	if(length == 0){
+		data = "";
+		return true;
+	}
+	mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if(mapping == NULL){
+		close();
+		return false;
+	}
+	data = (const char*) MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if(data == NULL){
+		close();
+		return false;
+	}
+#endif
+	return true;
+}
+
+void MappedFile::close(){
+#ifdef linux
+	if(data != NULL && length > 0)
+		munmap((void*) data, length);
+	if(fd >= 0)
+		::close(fd);
+	fd = -1;
+#else
+	if(data != NULL && length > 0)
+		UnmapViewOfFile(data);
+	if(mapping != NULL)
+		CloseHandle(mapping);
+	if(file != INVALID_HANDLE_VALUE)
+		CloseHandle(file);
+	mapping = NULL;
+	file = INVALID_HANDLE_VALUE;
+#endif
+	data = NULL;
+	length = 0;
+}
+
+bool MappedFile::isOpen() const {
+	return data != NULL;
+}
@@ -0,0 +1,48 @@
+/*
+ * MappedFile.h
+ */
+
+#ifndef SRC_MAPPEDFILE_H_
+#define SRC_MAPPEDFILE_H_
+
+#include <string>
+#include <cstddef>
+
+#ifndef linux
+#include <windows.h>
+#endif
+
+using namespace std;
+
+/**
+ * Read-only memory mapping of a whole file. The contents stay valid while the
+ * object lives; the file is unmapped by the destructor.
+ */
+class MappedFile {
+
+private:
+	const char* data;
+	size_t length;
+#ifdef linux
+	int fd;
+#else
+	HANDLE file;
+	HANDLE mapping;
+#endif
+
+	MappedFile(const MappedFile&);
+	MappedFile& operator=(const MappedFile&);
+
+public:
+	MappedFile();
+	virtual ~MappedFile();
+
+	bool open(const string& flName);
+	void close();
+	bool isOpen() const;
+	const char* begin() const { return data; }
+	const char* end() const { return data + length; }
+	size_t size() const { return length; }
+};
+
+#endif /* SRC_MAPPEDFILE_H_ */
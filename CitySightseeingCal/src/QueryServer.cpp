@@ -0,0 +1,415 @@
+/*
+ * QueryServer.cpp
+ */
+
+#include <cstring>
+#include <cstdio>
+#include <sstream>
+#include <algorithm>
+#include "QueryServer.h"
+
+#ifdef linux
+/* a client gone makes send fail instead of raising SIGPIPE */
+static const int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+static const int SEND_FLAGS = 0;
+#endif
+
+QueryServer::QueryServer(const TourPlanner& planner, int numThreads):
+		planner(planner), pool(numThreads), listenSock(0), listening(false), stopping(false) {
+}
+
+QueryServer::~QueryServer(){
+	stop();
+#ifdef linux
+	if(!unixPath.empty())
+		unlink(unixPath.c_str());
+#endif
+}
+
+void QueryServer::closeSocket(Socket sock){
+#ifdef linux
+	close(sock);
+#else
+	closesocket(sock);
+#endif
+}
+
+bool QueryServer::startListening(int family, const struct sockaddr* addr, size_t size){
+	listenSock = socket(family, SOCK_STREAM, 0);
+#ifdef linux
+	if(listenSock < 0)
+		return false;
+#else
+	if(listenSock == INVALID_SOCKET)
+		return false;
+#endif
+	if(family == AF_INET){
+		int on = 1;
+		setsockopt(listenSock, SOL_SOCKET, SO_REUSEADDR, (const char*) &on, sizeof(on));
+	}
+	if(bind(listenSock, addr, size) != 0 || listen(listenSock, SOMAXCONN) != 0){
+		closeSocket(listenSock);
+		return false;
+	}
+	listening = true;
+	return true;
+}
+
+/**
+ * Listens on localhost only. False if the port is not in 1..65535 or can not be bound.
+ */
+bool QueryServer::listenTcp(int port){
+	if(port < 1 || port > 65535)
+		return false;
+#ifndef linux
+	WSADATA wsaData;
+	if(WSAStartup(MAKEWORD(2,2), &wsaData) != NO_ERROR)
+		return false;
+#endif
+	struct sockaddr_in addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(port);
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	return startListening(AF_INET, (struct sockaddr*) &addr, sizeof(addr));
+}
+
+/**
+ * Listens on a Unix socket at path, replacing any file there; the file is
+ * removed when the server is destroyed. Always false outside linux.
+ */
+bool QueryServer::listenUnix(const string& path){
+#ifdef linux
+	struct sockaddr_un addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	if(path.size() >= sizeof(addr.sun_path))
+		return false;
+	strcpy(addr.sun_path, path.c_str());
+	unlink(path.c_str());
+	if(!startListening(AF_UNIX, (struct sockaddr*) &addr, sizeof(addr)))
+		return false;
+	unixPath = path;
+	return true;
+#else
+	return false;
+#endif
+}
+
+/**
+ * Accepts clients, each served by its own thread, until stop is called.
+ */
+void QueryServer::run(){
+	while(listening && !stopping){
+		Socket sock = accept(listenSock, NULL, NULL);
+#ifdef linux
+		if(sock < 0)
+			break;
+#else
+		if(sock == INVALID_SOCKET)
+			break;
+#endif
+		lock_guard<mutex> lock(clientsMutex);
+		if(stopping){
+			closeSocket(sock);
+			break;
+		}
+		for(size_t i = 0;i < clients.size();)
+			if(find(finishedClients.begin(), finishedClients.end(), clients[i].get_id()) != finishedClients.end()){
+				clients[i].join();
+				clients.erase(clients.begin() + i);
+			}
+			else
+				i++;
+		finishedClients.clear();
+		clientSocks.push_back(sock);
+		clients.push_back(thread(&QueryServer::serveClient, this, sock));
+	}
+}
+
+/**
+ * Stops accepting, disconnects the clients and waits for their threads.
+ * May be called from any thread.
+ */
+void QueryServer::stop(){
+	if(stopping.exchange(true))
+		return;
+	if(listening){
+#ifdef linux
+		shutdown(listenSock, SHUT_RDWR);
+#endif
+		closeSocket(listenSock);
+	}
+	vector<thread> toJoin;
+	{
+		lock_guard<mutex> lock(clientsMutex);
+		for(size_t i = 0;i < clientSocks.size();i++)
+#ifdef linux
+			shutdown(clientSocks[i], SHUT_RDWR);
+#else
+			shutdown(clientSocks[i], SD_BOTH);
+#endif
+		toJoin.swap(clients);
+	}
+	for(size_t i = 0;i < toJoin.size();i++)
+		toJoin[i].join();
+}
+
+bool QueryServer::writeAll(Socket sock, const string& data) const {
+	const char* p = data.data();
+	size_t size = data.size();
+	while(size > 0){
+		int n = send(sock, p, size, SEND_FLAGS);
+		if(n <= 0)
+			return false;
+		p += n;
+		size -= n;
+	}
+	return true;
+}
+
+/**
+ * Reads requests until the client disconnects. The complete lines of every
+ * read are handled in parallel on the pool and answered in order with one write.
+ */
+void QueryServer::serveClient(Socket sock){
+	vector<char> buffer(READ_BUFFER_SIZE);
+	string pending;
+	vector<string> lines, replies;
+	while(!stopping){
+		int n = recv(sock, &buffer[0], buffer.size(), 0);
+		if(n <= 0)
+			break;
+		pending.append(&buffer[0], n);
+
+		lines.clear();
+		size_t start = 0, newline;
+		while((newline = pending.find('\n', start)) != string::npos){
+			size_t end = newline;
+			if(end > start && pending[end-1] == '\r')
+				end--;
+			if(end > start)
+				lines.push_back(pending.substr(start, end - start));
+			start = newline + 1;
+		}
+		pending.erase(0, start);
+		if(pending.size() > MAX_REQUEST_SIZE){
+			writeAll(sock, "{\"ok\":false,\"error\":\"request too large\"}\n");
+			break;
+		}
+		if(lines.empty())
+			continue;
+
+		replies.assign(lines.size(), string());
+		vector<future<void> > tasks;
+		for(size_t i = 0;i < lines.size();i++)
+			tasks.push_back(pool.submit([this, i, &lines, &replies](){
+				replies[i] = handle(lines[i]);
+			}));
+		ThreadPool::waitAll(tasks);
+
+		string out;
+		for(size_t i = 0;i < replies.size();i++){
+			out += replies[i];
+			out += '\n';
+		}
+		if(!writeAll(sock, out))
+			break;
+	}
+
+	lock_guard<mutex> lock(clientsMutex);
+	for(size_t i = 0;i < clientSocks.size();i++)
+		if(clientSocks[i] == sock){
+			clientSocks.erase(clientSocks.begin() + i);
+			break;
+		}
+	closeSocket(sock);
+	finishedClients.push_back(this_thread::get_id());
+}
+
+/**
+ * Node of a POI given as a number or a string, -1 if it is not one.
+ */
+int QueryServer::readPoi(const JsonValue* v) const {
+	if(v == NULL)
+		return -1;
+	if(v->type == JsonValue::STRING)
+		return planner.readPoi(v->text);
+	if(!v->isInt())
+		return -1;
+	char buff[32];
+	sprintf(buff, "%d", (int) v->number);
+	return planner.readPoi(buff);
+}
+
+string QueryServer::handlePath(const JsonValue& request, JsonWriter& w) const {
+	int origin = readPoi(request.get("from"));
+	int dest = readPoi(request.get("to"));
+	if(origin == -1 || dest == -1)
+		return "invalid from or to";
+	double dist;
+	vector<int> path = planner.getShortestPath(origin, dest, dist);
+	if(path.empty())
+		return "no path";
+	w.key("ok"); w.value(true);
+	w.key("distance"); w.value(dist);
+	w.key("path"); w.values(path);
+	return "";
+}
+
+string QueryServer::handleTour(const JsonValue& request, JsonWriter& w) const {
+	const JsonValue* pois = request.get("pois");
+	if(pois == NULL || pois->type != JsonValue::ARRAY || pois->items.size() < 2)
+		return "pois must be an array of at least two POIs";
+	vector<int> nodes;
+	for(size_t i = 0;i < pois->items.size();i++){
+		nodes.push_back(readPoi(&pois->items[i]));
+		if(nodes.back() == -1)
+			return "invalid POI";
+	}
+	Route route = planner.planRoute(nodes);
+	if(!route.isComplete() || route.getStops().size() != nodes.size())
+		return "no path";
+	w.key("ok"); w.value(true);
+	w.key("stops"); w.values(route.getStops());
+	w.key("path"); w.values(route.getNodes());
+	return "";
+}
+
+/**
+ * Same as the batch mode: the POIs and tourists are turned into a TourPlan.
+ */
+string QueryServer::handlePlan(const JsonValue& request, JsonWriter& w) const {
+	const JsonValue* buses = request.get("buses");
+	const JsonValue* tourists = request.get("tourists");
+	if(buses == NULL || buses->type != JsonValue::ARRAY)
+		return "buses must be an array";
+	TourPlan plan;
+	for(size_t i = 0;i < buses->items.size();i++){
+		const JsonValue& bus = buses->items[i];
+		if(bus.type != JsonValue::ARRAY)
+			return "every bus must be an array of POIs";
+		vector<string> pois;
+		for(size_t j = 0;j < bus.items.size();j++){
+			const JsonValue& poi = bus.items[j];
+			if(poi.type == JsonValue::STRING)
+				pois.push_back(poi.text);
+			else if(poi.isInt()){
+				char buff[32];
+				sprintf(buff, "%d", (int) poi.number);
+				pois.push_back(buff);
+			}
+			else
+				return "invalid POI";
+		}
+		plan.addBus(pois);
+	}
+	if(tourists != NULL && tourists->type == JsonValue::ARRAY)
+		for(size_t i = 0;i < tourists->items.size();i++){
+			const JsonValue& t = tourists->items[i];
+			const JsonValue* name = t.get("name");
+			const JsonValue* poi = t.get("poi");
+			const JsonValue* with = t.get("with");
+			const JsonValue* query = poi != NULL ? poi : with;
+			if(name == NULL || name->type != JsonValue::STRING || query == NULL || query->type != JsonValue::STRING)
+				return "every tourist needs a name and a poi or with";
+			PlannedTourist tourist;
+			tourist.name = name->text;
+			tourist.choice = poi != NULL ? PlannedTourist::BY_POI : PlannedTourist::BY_PERSON;
+			tourist.query = query->text;
+			plan.addTourist(tourist);
+		}
+
+	PlanResult result = planner.execute(plan);
+	for(size_t i = 0;i < result.buses.size();i++){
+		const Route& route = result.buses[i].getRoute();
+		ostringstream error;
+		if(result.pois[i].size() < 2 || find(result.pois[i].begin(), result.pois[i].end(), -1) != result.pois[i].end())
+			error << "invalid POI in bus " << i+1;
+		else if(!route.isComplete() || route.getStops().size() != result.pois[i].size())
+			error << "no path for bus " << i+1;
+		if(!error.str().empty())
+			return error.str();
+	}
+	w.key("ok"); w.value(true);
+	w.key("result");
+	planner.writeResult(w, plan, result);
+	return "";
+}
+
+/**
+ * Echoes the id of the request, if it has one.
+ */
+void QueryServer::writeId(JsonWriter& w, const JsonValue* id){
+	if(id == NULL)
+		return;
+	w.key("id");
+	if(id->isInt())
+		w.value((int) id->number);
+	else if(id->type == JsonValue::NUMBER)
+		w.value(id->number);
+	else if(id->type == JsonValue::STRING)
+		w.value(id->text);
+	else
+		w.null();
+}
+
+/**
+ * Reply to a request already parsed, NULL if it is not a JSON object.
+ */
+string QueryServer::answer(const JsonValue* request) const {
+	ostringstream os;
+	JsonWriter w(os);
+	w.beginObject();
+	writeId(w, request != NULL ? request->get("id") : NULL);
+
+	const JsonValue* op = request != NULL ? request->get("op") : NULL;
+	string error;
+	if(request == NULL)
+		error = "invalid JSON object";
+	else if(op == NULL || op->type != JsonValue::STRING)
+		error = "missing op";
+	else if(op->text == "ping"){
+		w.key("ok"); w.value(true);
+	}
+	else if(op->text == "path")
+		error = handlePath(*request, w);
+	else if(op->text == "tour")
+		error = handleTour(*request, w);
+	else if(op->text == "plan")
+		error = handlePlan(*request, w);
+	else
+		error = "unknown op " + op->text;
+
+	if(!error.empty()){
+		w.key("ok"); w.value(false);
+		w.key("error"); w.value(error);
+	}
+	w.endObject();
+	return os.str();
+}
+
+/**
+ * Reply to one request line, without the newline. An exception while
+ * answering (out of memory on a huge request, for instance) only fails this
+ * request, instead of reaching the pool and ending the server.
+ */
+string QueryServer::handle(const string& request) const {
+	JsonValue v;
+	bool parsed = false;
+	try{
+		parsed = JsonReader(request).parse(v) && v.type == JsonValue::OBJECT;
+		return answer(parsed ? &v : NULL);
+	}
+	catch(const exception& e){
+		ostringstream os;
+		JsonWriter w(os);
+		w.beginObject();
+		writeId(w, parsed ? v.get("id") : NULL);
+		w.key("ok"); w.value(false);
+		w.key("error"); w.value(string("internal error: ") + e.what());
+		w.endObject();
+		return os.str();
+	}
+}
@@ -0,0 +1,97 @@
+/*
+ * QueryServer.h
+ */
+
+#ifndef SRC_QUERYSERVER_H_
+#define SRC_QUERYSERVER_H_
+
+#ifdef linux
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#else
+#include <winsock2.h>
+#endif
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include "TourPlanner.h"
+#include "ThreadPool.h"
+#include "JsonReader.h"
+#include "JsonWriter.h"
+
+using namespace std;
+
+/**
+ * Daemon that answers route queries on a local socket, TCP or (on linux)
+ * Unix, with one JSON object per line each way. The map is loaded once and
+ * every request runs on a ThreadPool whose workers share the read-only
+ * TourPlanner, so a request only costs its own searches.
+ *
+ *   {"id":1,"op":"path","from":poi,"to":poi}
+ *   {"id":2,"op":"tour","pois":[start,end,poi,...]}
+ *   {"id":3,"op":"plan","buses":[[start,end,...],...],"tourists":[{"name":n,"poi":p}|{"name":n,"with":other},...]}
+ *   {"id":4,"op":"ping"}
+ *
+ * POIs are node ids or "x,y" strings, as in the interactive mode. Every reply
+ * echoes "id" and has "ok", plus "error" when it is false, as it is when a
+ * path, tour or bus has a stop that can not be reached ("no path"), or when
+ * answering fails unexpectedly ("internal error: ..."). The replies
+ * to one client come in request order; requests that arrive together run in
+ * parallel.
+ */
+class QueryServer {
+
+public:
+	static const size_t READ_BUFFER_SIZE = 1 << 16;
+	static const size_t MAX_REQUEST_SIZE = 1 << 24;
+
+private:
+#ifdef linux
+	typedef int Socket;
+#else
+	typedef SOCKET Socket;
+#endif
+
+	const TourPlanner& planner;
+	ThreadPool pool;
+	Socket listenSock;
+	bool listening;
+	string unixPath;
+	atomic<bool> stopping;
+	mutex clientsMutex;
+	vector<thread> clients;
+	vector<Socket> clientSocks;
+	vector<thread::id> finishedClients;		//threads that ended and can be joined
+
+	bool startListening(int family, const struct sockaddr* addr, size_t size);
+	void serveClient(Socket sock);
+	bool writeAll(Socket sock, const string& data) const;
+	int readPoi(const JsonValue* v) const;
+	string handlePath(const JsonValue& request, JsonWriter& w) const;
+	string handleTour(const JsonValue& request, JsonWriter& w) const;
+	string handlePlan(const JsonValue& request, JsonWriter& w) const;
+	string answer(const JsonValue* request) const;
+	static void writeId(JsonWriter& w, const JsonValue* id);
+	static void closeSocket(Socket sock);
+
+	QueryServer(const QueryServer&);
+	QueryServer& operator=(const QueryServer&);
+
+public:
+	QueryServer(const TourPlanner& planner, int numThreads = 0);
+	virtual ~QueryServer();
+
+	bool listenTcp(int port);
+	bool listenUnix(const string& path);
+	void run();
+	void stop();
+	string handle(const string& request) const;
+};
+
+#endif /* SRC_QUERYSERVER_H_ */
@@ -0,0 +1,120 @@
+/*
+ * Route.cpp
+ */
+
+#include <utility>
+#include <algorithm>
+#include "Route.h"
+
+Route::Route(const vector<int>& stops): stops(stops), complete(!stops.empty()) {}
+
+Route::Route(Route&& other): stops(std::move(other.stops)), nodes(std::move(other.nodes)), complete(other.complete) {}
+
+Route& Route::operator=(Route&& other){
+	stops = std::move(other.stops);
+	nodes = std::move(other.nodes);
+	complete = other.complete;
+	return *this;
+}
+
+/**
+ * Expands every segment into the full node sequence. The size of the result is
+ * computed first so that the buffer is allocated only once.
+ * Requires g.floydWarshallShortestPath() to have been called.
+ */
+void Route::expand(const Graph<int>& g){
+	nodes.clear();
+	complete = !stops.empty();
+	if(stops.empty())
+		return;
+
+	size_t total = 1;
+	for(int j = 0;j < getNumSegments();j++)
+		total += g.getfloydWarshallPathSize(stops[j], stops[j+1]) - 1;
+	nodes.reserve(total);
+
+	nodes.push_back(stops[0]);
+	for(int j = 0;j < getNumSegments();j++){
+		nodes.pop_back();
+		g.appendfloydWarshallPath(stops[j], stops[j+1], nodes);
+	}
+}
+
+/**
+ * Expands every segment with searches already made on the CompactGraph:
+ * searches[i] is a search from sources[i]. If a stop is not one of the
+ * sources or a segment has no path, the route is left without nodes and not
+ * complete.
+ */
+void Route::expand(const CompactGraph& g, const vector<int>& sources, const vector<ShortestPaths>& searches){
+	expandWithSearches(g, sources, searches);
+}
+
+/**
+ * Same with searches made on the contracted graph (ContractedGraph::dijkstraShortestPath),
+ * so the stops do not need to be kept vertices.
+ */
+void Route::expand(const ContractedGraph& g, const vector<int>& sources, const vector<ShortestPaths>& searches){
+	expandWithSearches(g, sources, searches);
+}
+
+/**
+ * Both graphs read a search with getPathSize and appendPath. The paths are
+ * measured first so that the buffer is allocated once.
+ */
+template <class G>
+void Route::expandWithSearches(const G& g, const vector<int>& sources, const vector<ShortestPaths>& searches){
+	nodes.clear();
+	complete = !stops.empty();
+	if(stops.empty())
+		return;
+
+	vector<size_t> searchOf(getNumSegments());
+	size_t total = 1;
+	for(int j = 0;j < getNumSegments();j++){
+		searchOf[j] = find(sources.begin(), sources.end(), stops[j]) - sources.begin();
+		int size = searchOf[j] < searches.size() ? g.getPathSize(searches[searchOf[j]], stops[j+1]) : 0;
+		if(size == 0){
+			complete = false;
+			return;
+		}
+		total += size - 1;
+	}
+	nodes.reserve(total);
+
+	nodes.push_back(stops[0]);
+	for(int j = 0;j < getNumSegments();j++)
+		g.appendPath(searches[searchOf[j]], stops[j+1], nodes);
+}
+
+bool Route::isExpanded() const {
+	return !nodes.empty();
+}
+
+/**
+ * False if the route has no stops (no tour was found) or if the last
+ * expansion found a segment without path.
+ */
+bool Route::isComplete() const {
+	return complete;
+}
+
+int Route::getNumSegments() const {
+	return stops.empty() ? 0 : stops.size() - 1;
+}
+
+const vector<int>& Route::getStops() const {
+	return stops;
+}
+
+const vector<int>& Route::getNodes() const {
+	return nodes;
+}
+
+size_t Route::size() const {
+	return nodes.size();
+}
+
+int Route::operator[](size_t i) const {
+	return nodes[i];
+}
@@ -0,0 +1,53 @@
+/*
+ * Route.h
+ */
+
+#ifndef SRC_ROUTE_H_
+#define SRC_ROUTE_H_
+
+#include <vector>
+#include "Graph.h"
+#include "ContractedGraph.h"
+
+using namespace std;
+
+/**
+ * Route of a bus. Keeps the POIs in visiting order, each pair of consecutive
+ * POIs being one segment, and expands all the segments into a single buffer,
+ * either with the Floyd-Warshall paths of a Graph or with shortest path
+ * searches. The size of every segment is known before copying its nodes, so
+ * the buffer is reserved once.
+ * A route can only be moved, never copied.
+ */
+class Route {
+
+private:
+	vector<int> stops;
+	vector<int> nodes;
+	bool complete;
+
+	template <class G>
+	void expandWithSearches(const G& g, const vector<int>& sources, const vector<ShortestPaths>& searches);
+
+public:
+	Route(): complete(false) {};
+	Route(const vector<int>& stops);
+	Route(Route&& other);
+	Route& operator=(Route&& other);
+	Route(const Route& other) = delete;
+	Route& operator=(const Route& other) = delete;
+	virtual ~Route(){};
+
+	void expand(const Graph<int>& g);
+	void expand(const CompactGraph& g, const vector<int>& sources, const vector<ShortestPaths>& searches);
+	void expand(const ContractedGraph& g, const vector<int>& sources, const vector<ShortestPaths>& searches);
+	bool isExpanded() const;
+	bool isComplete() const;
+	int getNumSegments() const;
+	const vector<int>& getStops() const;
+	const vector<int>& getNodes() const;
+	size_t size() const;
+	int operator[](size_t i) const;
+};
+
+#endif /* SRC_ROUTE_H_ */
@@ -0,0 +1,218 @@
+/*
+ * SocketRenderer.cpp
+ */
+
+#include <cstdio>
+#include <sstream>
+#include "SocketRenderer.h"
+
+#ifdef linux
+pid_t SocketRenderer::procId = 0;
+#endif
+
+SocketRenderer::SocketRenderer(int width, int height, bool dynamic, int port, bool launchController) {
+	if(launchController)
+		launch(port);
+	// connects as soon as the controller listens
+	con = new Connection(port);
+
+	char buff[200];
+	sprintf(buff, "newGraph %d %d %s\n", width, height, (dynamic?"true":"false"));
+	send(buff);
+}
+
+SocketRenderer::~SocketRenderer(){
+	delete con;
+}
+
+void SocketRenderer::launch(int port) {
+	string command = "java -jar GraphViewerController.jar";
+	std::stringstream ss;
+	ss << port;
+	string port_string = ss.str();
+	command += " --port ";
+	command += port_string;
+
+#ifdef linux
+	if (!(procId = fork())) {
+		system(command.c_str());
+		kill(getppid(), SIGINT);
+		exit(0);
+	}
+#else
+	STARTUPINFO si;
+	PROCESS_INFORMATION pi;
+	ZeroMemory( &si, sizeof(si) );
+	si.cb = sizeof(si);
+	ZeroMemory( &pi, sizeof(pi) );
+	LPSTR command_lpstr = const_cast<char *>(command.c_str());
+	if( !CreateProcess( NULL,   // No module name (use command line)
+			command_lpstr,        // Command line
+			NULL,           // Process handle not inheritable
+			NULL,           // Thread handle not inheritable
+			FALSE,          // Set handle inheritance to FALSE
+			0,              // No creation flags
+			NULL,           // Use parent's environment block
+			NULL,           // Use parent's starting directory
+			&si,            // Pointer to STARTUPINFO structure
+			&pi )           // Pointer to PROCESS_INFORMATION structure
+	) {
+		cerr << "CreateProcess failed " << GetLastError() << endl;
+		return;
+	}
+
+	// Close process and thread handles.
+	CloseHandle( pi.hProcess );
+	CloseHandle( pi.hThread );
+#endif
+}
+
+bool SocketRenderer::send(const char *command) {
+	return con->sendMsg(command);
+}
+
+bool SocketRenderer::createWindow(int width, int height) {
+	char buff[200];
+	sprintf(buff, "createWindow %d %d\n", width, height);
+	return send(buff);
+}
+
+bool SocketRenderer::closeWindow() {
+	return send("closeWindow\n");
+}
+
+bool SocketRenderer::addNode(int id) {
+	char buff[200];
+	sprintf(buff, "addNode1 %d\n", id);
+	return send(buff);
+}
+
+bool SocketRenderer::addNode(int id, int x, int y) {
+	char buff[200];
+	sprintf(buff, "addNode3 %d %d %d\n", id, x, y);
+	return send(buff);
+}
+
+bool SocketRenderer::addEdge(int id, int v1, int v2, int edgeType) {
+	char buff[200];
+	sprintf(buff, "addEdge %d %d %d %d\n", id, v1, v2, edgeType);
+	return send(buff);
+}
+
+bool SocketRenderer::setEdgeLabel(int k, string label) {
+	char buff[200];
+	sprintf(buff, "setEdgeLabel %d ", k);
+	return send((buff + label + "\n").c_str());
+}
+
+bool SocketRenderer::setVertexLabel(int k, string label) {
+	char buff[200];
+	sprintf(buff, "setVertexLabel %d ", k);
+	return send((buff + label + "\n").c_str());
+}
+
+bool SocketRenderer::defineEdgeColor(string color) {
+	return send(("defineEdgeColor " + color + "\n").c_str());
+}
+
+bool SocketRenderer::removeNode(int id) {
+	char buff[200];
+	sprintf(buff, "removeNode %d\n", id);
+	return send(buff);
+}
+
+bool SocketRenderer::removeEdge(int id) {
+	char buff[200];
+	sprintf(buff, "removeEdge %d\n", id);
+	return send(buff);
+}
+
+bool SocketRenderer::setEdgeColor(int k, string color) {
+	char buff[200];
+	sprintf(buff, "setEdgeColor %d %s\n", k, color.c_str());
+	return send(buff);
+}
+
+bool SocketRenderer::defineEdgeDashed(bool dashed) {
+	char buff[200];
+	sprintf(buff, "defineEdgeDashed %s\n", dashed? "true" : "false");
+	return send(buff);
+}
+
+bool SocketRenderer::setEdgeDashed(int k, bool dashed) {
+	char buff[200];
+	sprintf(buff, "setEdgeDashed %d %s\n", k, dashed? "true" : "false");
+	return send(buff);
+}
+
+bool SocketRenderer::defineEdgeCurved(bool curved) {
+	char buff[200];
+	sprintf(buff, "defineEdgeCurved %s\n", curved? "true" : "false");
+	return send(buff);
+}
+
+bool SocketRenderer::setEdgeThickness(int k, int thickness) {
+	char buff[200];
+	sprintf(buff, "setEdgeThickness %d %d\n", k, thickness);
+	return send(buff);
+}
+
+bool SocketRenderer::defineVertexColor(string color) {
+	return send(("defineVertexColor " + color + "\n").c_str());
+}
+
+bool SocketRenderer::setVertexColor(int k, string color) {
+	char buff[200];
+	sprintf(buff, "setVertexColor %d %s\n", k, color.c_str());
+	return send(buff);
+}
+
+bool SocketRenderer::defineVertexIcon(string filepath) {
+	return send(("defineVertexIcon " + filepath + "\n").c_str());
+}
+
+bool SocketRenderer::setVertexIcon(int k, string filepath) {
+	char buff[200];
+	sprintf(buff, "setVertexIcon %d ", k);
+	return send((buff + filepath + "\n").c_str());
+}
+
+bool SocketRenderer::defineVertexSize(int size) {
+	char buff[200];
+	sprintf(buff, "defineVertexSize %d\n", size);
+	return send(buff);
+}
+
+bool SocketRenderer::setVertexSize(int k, int size) {
+	char buff[200];
+	sprintf(buff, "setVertexSize %d %d\n", k, size);
+	return send(buff);
+}
+
+bool SocketRenderer::setBackground(string path) {
+	return send(("setBackground " + path + "\n").c_str());
+}
+
+bool SocketRenderer::setEdgeWeight(int id, int weight) {
+	char buff[200];
+	sprintf(buff, "setEdgeWeight %d %d\n", id, weight);
+	return send(buff);
+}
+
+bool SocketRenderer::setEdgeFlow(int id, int flow) {
+	char buff[200];
+	sprintf(buff, "setEdgeFlow %d %d\n", id, flow);
+	return send(buff);
+}
+
+bool SocketRenderer::rearrange() {
+	return send("rearrange\n");
+}
+
+void SocketRenderer::setBatching(bool batching, bool fireAndForget) {
+	con->setBatching(batching, fireAndForget);
+}
+
+bool SocketRenderer::flush() {
+	return con->flush();
+}
@@ -0,0 +1,80 @@
+/*
+ * SocketRenderer.h
+ */
+
+#ifndef SRC_SOCKETRENDERER_H_
+#define SRC_SOCKETRENDERER_H_
+
+#ifdef linux
+#include <unistd.h>
+#else
+#include <winsock2.h>
+#include <Windows.h>
+#endif
+
+#include <stdlib.h>
+#include <signal.h>
+#include <string>
+
+#include "GraphRenderer.h"
+#include "connection.h"
+
+using namespace std;
+
+/**
+ * Draws the graph in the Java viewer (GraphViewerController.jar), sending one
+ * text command per call over a local TCP connection.
+ * With launchController the viewer is started as a child process; otherwise
+ * one must already be listening, or start soon, on the given port.
+ */
+class SocketRenderer: public GraphRenderer {
+
+private:
+	Connection *con;
+
+	void launch(int port);
+	bool send(const char *command);
+
+public:
+#ifdef linux
+	static pid_t procId;
+#endif
+
+	SocketRenderer(int width, int height, bool dynamic, int port, bool launchController = true);
+	virtual ~SocketRenderer();
+
+	bool createWindow(int width, int height);
+	bool closeWindow();
+
+	bool addNode(int id, int x, int y);
+	bool addNode(int id);
+	bool addEdge(int id, int v1, int v2, int edgeType);
+	bool removeNode(int id);
+	bool removeEdge(int id);
+
+	bool setVertexLabel(int id, string label);
+	bool setEdgeLabel(int id, string label);
+	bool setEdgeColor(int id, string color);
+	bool setEdgeDashed(int id, bool dashed);
+	bool setVertexColor(int id, string color);
+	bool setVertexSize(int id, int size);
+	bool setVertexIcon(int id, string filepath);
+	bool setEdgeThickness(int id, int thickness);
+	bool setEdgeWeight(int id, int weight);
+	bool setEdgeFlow(int id, int flow);
+
+	bool defineEdgeCurved(bool curved);
+	bool defineEdgeColor(string color);
+	bool defineEdgeDashed(bool dashed);
+	bool defineVertexColor(string color);
+	bool defineVertexSize(int size);
+	bool defineVertexIcon(string filepath);
+	bool setBackground(string path);
+
+	bool rearrange();
+
+	void setBatching(bool batching, bool fireAndForget);
+	bool flush();
+};
+
+#endif /* SRC_SOCKETRENDERER_H_ */
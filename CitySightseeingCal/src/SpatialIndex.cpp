@@ -0,0 +1,259 @@
+/*
+ * SpatialIndex.cpp
+ */
+
+#include <algorithm>
+#include "SpatialIndex.h"
+#include "ThreadPool.h"
+
+/**
+ * Orders the points of a range by one coordinate, the id breaking ties.
+ */
+struct coordinate_less_than {
+	const vector<pair<double,double> >& points;
+	int axis;
+	coordinate_less_than(const vector<pair<double,double> >& points, int axis): points(points), axis(axis) {}
+	bool operator()(int a, int b) const {
+		double ca = axis == 0 ? points[a].first : points[a].second;
+		double cb = axis == 0 ? points[b].first : points[b].second;
+		return ca < cb || (ca == cb && a < b);
+	}
+};
+
+static inline double squaredDist(double x1, double y1, double x2, double y2){
+	return (x1-x2)*(x1-x2) + (y1-y2)*(y1-y2);
+}
+
+/**
+ * True if the candidate (d, id) is closer than (bestDist, best).
+ */
+static inline bool closer(double d, int id, double bestDist, int best){
+	return best == -1 || d < bestDist || (d == bestDist && id < best);
+}
+
+SpatialIndex::SpatialIndex(const vector<pair<double,double> >& points, const vector<bool>& removed){
+	ids.reserve(points.size());
+	for(size_t i = 0;i < points.size();i++)
+		if(i >= removed.size() || !removed[i])
+			ids.push_back(i);
+	xs.resize(ids.size());
+	ys.resize(ids.size());
+	splitAxis.assign(ids.size(), 0);
+	build(0, ids.size(), points);
+	for(size_t i = 0;i < ids.size();i++){
+		xs[i] = points[ids[i]].first;
+		ys[i] = points[ids[i]].second;
+	}
+}
+
+/**
+ * Splits the range by the median of the coordinate with the larger spread.
+ */
+void SpatialIndex::build(int lo, int hi, const vector<pair<double,double> >& points){
+	if(hi - lo <= LEAF_SIZE)
+		return;
+	double minX = points[ids[lo]].first, maxX = minX;
+	double minY = points[ids[lo]].second, maxY = minY;
+	for(int i = lo+1;i < hi;i++){
+		const pair<double,double>& p = points[ids[i]];
+		minX = min(minX, p.first); maxX = max(maxX, p.first);
+		minY = min(minY, p.second); maxY = max(maxY, p.second);
+	}
+	int axis = (maxY - minY > maxX - minX) ? 1 : 0;
+	int mid = (lo + hi) / 2;
+	nth_element(ids.begin() + lo, ids.begin() + mid, ids.begin() + hi, coordinate_less_than(points, axis));
+	splitAxis[mid] = axis;
+	build(lo, mid, points);
+	build(mid + 1, hi, points);
+}
+
+void SpatialIndex::searchNearest(int lo, int hi, double x, double y, int& best, double& bestDist) const {
+	if(hi - lo <= LEAF_SIZE){
+		for(int i = lo;i < hi;i++){
+			double d = squaredDist(x, y, xs[i], ys[i]);
+			if(closer(d, ids[i], bestDist, best)){
+				best = ids[i];
+				bestDist = d;
+			}
+		}
+		return;
+	}
+	int mid = (lo + hi) / 2;
+	double d = squaredDist(x, y, xs[mid], ys[mid]);
+	if(closer(d, ids[mid], bestDist, best)){
+		best = ids[mid];
+		bestDist = d;
+	}
+	double diff = splitAxis[mid] == 0 ? x - xs[mid] : y - ys[mid];
+	if(diff < 0){
+		searchNearest(lo, mid, x, y, best, bestDist);
+		if(diff*diff <= bestDist)
+			searchNearest(mid + 1, hi, x, y, best, bestDist);
+	}
+	else{
+		searchNearest(mid + 1, hi, x, y, best, bestDist);
+		if(diff*diff <= bestDist)
+			searchNearest(lo, mid, x, y, best, bestDist);
+	}
+}
+
+/**
+ * heap is a max-heap of (squared distance, id) with at most k entries.
+ */
+void SpatialIndex::searchKNearest(int lo, int hi, double x, double y, size_t k, vector<pair<double,int> >& heap) const {
+	int mid = (lo + hi) / 2;
+	bool leaf = hi - lo <= LEAF_SIZE;
+	for(int i = leaf ? lo : mid;i < (leaf ? hi : mid + 1);i++){
+		pair<double,int> entry(squaredDist(x, y, xs[i], ys[i]), ids[i]);
+		if(heap.size() < k){
+			heap.push_back(entry);
+			push_heap(heap.begin(), heap.end());
+		}
+		else if(entry < heap.front()){
+			pop_heap(heap.begin(), heap.end());
+			heap.back() = entry;
+			push_heap(heap.begin(), heap.end());
+		}
+	}
+	if(leaf)
+		return;
+
+	double diff = splitAxis[mid] == 0 ? x - xs[mid] : y - ys[mid];
+	int nearLo = diff < 0 ? lo : mid + 1, nearHi = diff < 0 ? mid : hi;
+	int farLo = diff < 0 ? mid + 1 : lo, farHi = diff < 0 ? hi : mid;
+	searchKNearest(nearLo, nearHi, x, y, k, heap);
+	if(heap.size() < k || diff*diff <= heap.front().first)
+		searchKNearest(farLo, farHi, x, y, k, heap);
+}
+
+void SpatialIndex::searchRadius(int lo, int hi, double x, double y, double radius2, vector<pair<double,int> >& res) const {
+	int mid = (lo + hi) / 2;
+	bool leaf = hi - lo <= LEAF_SIZE;
+	for(int i = leaf ? lo : mid;i < (leaf ? hi : mid + 1);i++){
+		double d = squaredDist(x, y, xs[i], ys[i]);
+		if(d <= radius2)
+			res.push_back(pair<double,int>(d, ids[i]));
+	}
+	if(leaf)
+		return;
+
+	double diff = splitAxis[mid] == 0 ? x - xs[mid] : y - ys[mid];
+	if(diff <= 0 || diff*diff <= radius2)
+		searchRadius(lo, mid, x, y, radius2, res);
+	if(diff >= 0 || diff*diff <= radius2)
+		searchRadius(mid + 1, hi, x, y, radius2, res);
+}
+
+/**
+ * Stops as soon as res holds limit ids.
+ */
+void SpatialIndex::searchRect(int lo, int hi, double minX, double minY, double maxX, double maxY, vector<int>& res, size_t limit) const {
+	int mid = (lo + hi) / 2;
+	bool leaf = hi - lo <= LEAF_SIZE;
+	for(int i = leaf ? lo : mid;i < (leaf ? hi : mid + 1) && res.size() < limit;i++)
+		if(xs[i] >= minX && xs[i] <= maxX && ys[i] >= minY && ys[i] <= maxY)
+			res.push_back(ids[i]);
+	if(leaf || res.size() >= limit)
+		return;
+
+	double split = splitAxis[mid] == 0 ? xs[mid] : ys[mid];
+	double low = splitAxis[mid] == 0 ? minX : minY;
+	double high = splitAxis[mid] == 0 ? maxX : maxY;
+	if(low <= split)
+		searchRect(lo, mid, minX, minY, maxX, maxY, res, limit);
+	if(high >= split)
+		searchRect(mid + 1, hi, minX, minY, maxX, maxY, res, limit);
+}
+
+/**
+ * Id of the node closest to (x, y), or -1 if the index is empty.
+ */
+int SpatialIndex::nearest(double x, double y) const {
+	int best = -1;
+	double bestDist = 0;
+	searchNearest(0, ids.size(), x, y, best, bestDist);
+	return best;
+}
+
+/**
+ * Ids of the k nodes closest to (x, y), closest first.
+ */
+vector<int> SpatialIndex::kNearest(double x, double y, size_t k) const {
+	vector<pair<double,int> > heap;
+	vector<int> res;
+	if(k == 0 || ids.empty())
+		return res;
+	heap.reserve(k);
+	searchKNearest(0, ids.size(), x, y, k, heap);
+	sort_heap(heap.begin(), heap.end());
+	for(size_t i = 0;i < heap.size();i++)
+		res.push_back(heap[i].second);
+	return res;
+}
+
+/**
+ * Ids of the nodes at distance at most radius from (x, y), closest first.
+ */
+vector<int> SpatialIndex::inRadius(double x, double y, double radius) const {
+	vector<pair<double,int> > found;
+	vector<int> res;
+	if(ids.empty() || radius < 0)
+		return res;
+	searchRadius(0, ids.size(), x, y, radius*radius, found);
+	sort(found.begin(), found.end());
+	for(size_t i = 0;i < found.size();i++)
+		res.push_back(found[i].second);
+	return res;
+}
+
+/**
+ * Ids of the nodes inside the rectangle, borders included, sorted by id.
+ */
+vector<int> SpatialIndex::inRect(double minX, double minY, double maxX, double maxY) const {
+	vector<int> res;
+	if(ids.empty() || minX > maxX || minY > maxY)
+		return res;
+	searchRect(0, ids.size(), minX, minY, maxX, maxY, res, ids.size());
+	sort(res.begin(), res.end());
+	return res;
+}
+
+/**
+ * Number of nodes inside the rectangle, counting no further than limit, so
+ * that asking whether a large area holds more than a few nodes is cheap.
+ */
+size_t SpatialIndex::countInRect(double minX, double minY, double maxX, double maxY, size_t limit) const {
+	vector<int> res;
+	if(ids.empty() || minX > maxX || minY > maxY)
+		return 0;
+	searchRect(0, ids.size(), minX, minY, maxX, maxY, res, limit);
+	return res.size();
+}
+
+/**
+ * Nearest node of every point. Large batches are split in blocks that are
+ * snapped in parallel on the default thread pool.
+ */
+vector<int> SpatialIndex::snap(const vector<pair<double,double> >& points) const {
+	vector<int> res(points.size(), -1);
+	ThreadPool& pool = ThreadPool::getDefault();
+	size_t numBlocks = 1;
+	if(points.size() >= PARALLEL_MIN_POINTS && pool.size() > 1)
+		numBlocks = pool.size();
+	size_t blockSize = (points.size() + numBlocks - 1) / numBlocks;
+
+	vector<future<void> > tasks;
+	for(size_t b = 0;b < numBlocks;b++){
+		size_t begin = min(points.size(), b*blockSize), end = min(points.size(), begin + blockSize);
+		function<void()> task = [=, &points, &res](){
+			for(size_t i = begin;i < end;i++)
+				res[i] = nearest(points[i].first, points[i].second);
+		};
+		if(numBlocks == 1)
+			task();
+		else
+			tasks.push_back(pool.submit(task));
+	}
+	ThreadPool::waitAll(tasks);
+	return res;
+}
@@ -0,0 +1,53 @@
+/*
+ * SpatialIndex.h
+ */
+
+#ifndef SRC_SPATIALINDEX_H_
+#define SRC_SPATIALINDEX_H_
+
+#include <vector>
+
+using namespace std;
+
+/**
+ * Static k-d tree over the projected coordinates of the nodes (MapReading::getNodes),
+ * used to snap locations given as coordinates to the nearest node of the map.
+ * Points flagged in removed are left out.
+ *
+ * The tree is implicit: the points are reordered so that the median of every
+ * range [lo, hi) is at (lo+hi)/2, with the smaller coordinates on the left, so
+ * no node objects are allocated. Queries take O(log n) on average.
+ * When two nodes are at the same distance the one with the smaller id comes first.
+ */
+class SpatialIndex {
+
+private:
+	vector<int> ids;
+	vector<double> xs;
+	vector<double> ys;
+	vector<unsigned char> splitAxis;
+
+	static const int LEAF_SIZE = 8;
+	static const size_t PARALLEL_MIN_POINTS = 1024;
+
+	void build(int lo, int hi, const vector<pair<double,double> >& points);
+	void searchNearest(int lo, int hi, double x, double y, int& best, double& bestDist) const;
+	void searchKNearest(int lo, int hi, double x, double y, size_t k, vector<pair<double,int> >& heap) const;
+	void searchRadius(int lo, int hi, double x, double y, double radius2, vector<pair<double,int> >& res) const;
+	void searchRect(int lo, int hi, double minX, double minY, double maxX, double maxY, vector<int>& res, size_t limit) const;
+
+public:
+	SpatialIndex(){};
+	SpatialIndex(const vector<pair<double,double> >& points, const vector<bool>& removed = vector<bool>());
+	virtual ~SpatialIndex(){};
+
+	size_t size() const { return ids.size(); }
+	int nearest(double x, double y) const;
+	vector<int> kNearest(double x, double y, size_t k) const;
+	vector<int> inRadius(double x, double y, double radius) const;
+	vector<int> inRect(double minX, double minY, double maxX, double maxY) const;
+	size_t countInRect(double minX, double minY, double maxX, double maxY, size_t limit) const;
+	vector<int> snap(const vector<pair<double,double> >& points) const;
+};
+
+#endif /* SRC_SPATIALINDEX_H_ */
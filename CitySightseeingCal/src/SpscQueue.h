@@ -0,0 +1,86 @@
+/*
+ * SpscQueue.h
+ */
+
+#ifndef SRC_SPSCQUEUE_H_
+#define SRC_SPSCQUEUE_H_
+
+#include <vector>
+#include <atomic>
+#include <utility>
+
+using namespace std;
+
+/**
+ * Bounded lock-free queue for exactly one producer thread and one consumer
+ * thread. The slots form a ring whose size is a power of two; the producer
+ * only writes tail and the consumer only writes head, so neither side ever
+ * takes a lock. Both indices only grow and are masked to find the slot.
+ */
+template <class T>
+class SpscQueue {
+
+private:
+	vector<T> slots;
+	size_t mask;
+	atomic<size_t> head;		//next slot to pop, written by the consumer
+	char padding[64];			//keeps head and tail on different cache lines
+	atomic<size_t> tail;		//next slot to push, written by the producer
+
+	SpscQueue(const SpscQueue&);
+	SpscQueue& operator=(const SpscQueue&);
+
+public:
+	SpscQueue(size_t capacity);
+
+	bool tryPush(T&& value);
+	bool tryPop(T& value);
+	bool empty() const;
+	size_t capacity() const { return slots.size(); }
+};
+
+/**
+ * The capacity is rounded up to a power of two.
+ */
+template <class T>
+SpscQueue<T>::SpscQueue(size_t capacity): head(0), tail(0) {
+	size_t size = 1;
+	while(size < capacity)
+		size *= 2;
+	slots.resize(size);
+	mask = size - 1;
+}
+
+/**
+ * Producer side. Moves value into the queue, or leaves it untouched and
+ * returns false if the queue is full.
+ */
+template <class T>
+bool SpscQueue<T>::tryPush(T&& value){
+	size_t t = tail.load(memory_order_relaxed);
+	if(t - head.load(memory_order_acquire) == slots.size())
+		return false;
+	slots[t & mask] = std::move(value);
+	tail.store(t + 1, memory_order_release);
+	return true;
+}
+
+/**
+ * Consumer side. False if the queue is empty.
+ */
+template <class T>
+bool SpscQueue<T>::tryPop(T& value){
+	size_t h = head.load(memory_order_relaxed);
+	if(h == tail.load(memory_order_acquire))
+		return false;
+	value = std::move(slots[h & mask]);
+	head.store(h + 1, memory_order_release);
+	return true;
+}
+
+template <class T>
+bool SpscQueue<T>::empty() const {
+	return head.load(memory_order_acquire) == tail.load(memory_order_acquire);
+}
+
+#endif /* SRC_SPSCQUEUE_H_ */
@@ -14,7 +14,7 @@
 
 using namespace std;
 
-vector<int> computePrefixSum(string p) {
+inline vector<int> computePrefixSum(string p) {
 
 	int m = p.size();
 	vector<int> pi(m);
@@ -33,7 +33,7 @@ vector<int> computePrefixSum(string p) {
 	return pi;
 }
 
-int kmp_matcher(string t, string p) {
+inline int kmp_matcher(string t, string p) {
 	int count = 0;
 	int n = t.size();
 	int m = p.size();
@@ -54,7 +54,7 @@ int kmp_matcher(string t, string p) {
 	return count;
 }
 
-int numStringMatching(string filename, string toSearch) {
+inline int numStringMatching(string filename, string toSearch) {
 	int count = 0;
 	ifstream ifs;
 	ifs.open(filename.c_str(), std::ifstream::in);
@@ -72,7 +72,7 @@ int numStringMatching(string filename, string toSearch) {
 	return count;
 }
 
-int editDistance(string p, string t) {
+inline int editDistance(string p, string t) {
 	vector<vector<int> > dp(p.size() + 1, vector<int>(t.size() + 1));
 	for (size_t i = 0; i <= p.size(); i++) {
 		dp[i][0] = i;
@@ -95,7 +95,7 @@ int editDistance(string p, string t) {
 	return dp[p.size()][t.size()];
 }
 
-float numApproximateStringMatching(string filename, string toSearch) {
+inline float numApproximateStringMatching(string filename, string toSearch) {
 	int count = 0;
 	int sumEdit = 0;
 	ifstream ifs;
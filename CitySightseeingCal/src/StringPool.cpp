@@ -0,0 +1,59 @@
+/*
+ * StringPool.cpp
+ */
+
+#include <cstring>
+#include "StringPool.h"
+
+StringPool::StringPool(): offsets(1, 0), table(16, 0) {}
+
+/**
+ * FNV-1a
+ */
+uint32_t StringPool::hash(const char* begin, const char* end){
+	uint32_t h = 2166136261u;
+	for(const char* p = begin;p < end;p++){
+		h ^= (unsigned char) *p;
+		h *= 16777619u;
+	}
+	return h;
+}
+
+bool StringPool::equals(uint32_t id, const char* begin, const char* end) const {
+	size_t n = end - begin;
+	return length(id) == n && (n == 0 || memcmp(chars.data() + offsets[id], begin, n) == 0);
+}
+
+void StringPool::rehash(size_t capacity){
+	table.assign(capacity, 0);
+	for(uint32_t id = 0;id < size();id++){
+		size_t slot = hash(data(id), data(id) + length(id)) & (capacity - 1);
+		while(table[slot] != 0)
+			slot = (slot + 1) & (capacity - 1);
+		table[slot] = id + 1;
+	}
+}
+
+/**
+ * Id of the string [begin, end), added to the pool if it is not there yet.
+ */
+uint32_t StringPool::intern(const char* begin, const char* end){
+	size_t slot = hash(begin, end) & (table.size() - 1);
+	while(table[slot] != 0){
+		if(equals(table[slot] - 1, begin, end))
+			return table[slot] - 1;
+		slot = (slot + 1) & (table.size() - 1);
+	}
+
+	uint32_t id = size();
+	chars.insert(chars.end(), begin, end);
+	offsets.push_back(chars.size());
+	table[slot] = id + 1;
+	if(2*size() > table.size())
+		rehash(2*table.size());
+	return id;
+}
+
+uint32_t StringPool::intern(const string& s){
+	return intern(s.data(), s.data() + s.size());
+}
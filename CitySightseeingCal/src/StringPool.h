@@ -0,0 +1,42 @@
+/*
+ * StringPool.h
+ */
+
+#ifndef SRC_STRINGPOOL_H_
+#define SRC_STRINGPOOL_H_
+
+#include <vector>
+#include <string>
+#include <stdint.h>
+
+using namespace std;
+
+/**
+ * Interned strings, such as the road names. Every distinct string is stored
+ * once in a single character buffer and referenced by a 32-bit id; interning
+ * the same text again returns the same id.
+ */
+class StringPool {
+
+private:
+	vector<char> chars;
+	vector<uint32_t> offsets;		//string i is chars[offsets[i]] .. chars[offsets[i+1]-1]
+	vector<uint32_t> table;			//open addressing, id+1 of each string, 0 if empty
+
+	static uint32_t hash(const char* begin, const char* end);
+	bool equals(uint32_t id, const char* begin, const char* end) const;
+	void rehash(size_t capacity);
+
+public:
+	StringPool();
+	virtual ~StringPool(){};
+
+	uint32_t intern(const char* begin, const char* end);
+	uint32_t intern(const string& s);
+	size_t size() const { return offsets.size() - 1; }
+	size_t length(uint32_t id) const { return offsets[id+1] - offsets[id]; }
+	const char* data(uint32_t id) const { return chars.empty() ? "" : chars.data() + offsets[id]; }
+	string get(uint32_t id) const { return string(data(id), length(id)); }
+};
+
+#endif /* SRC_STRINGPOOL_H_ */
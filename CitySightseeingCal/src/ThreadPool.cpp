@@ -0,0 +1,83 @@
+/*
+ * ThreadPool.cpp
+ */
+
+#include <memory>
+#include "ThreadPool.h"
+
+/**
+ * Creates numThreads workers, or one per hardware thread when numThreads is 0.
+ */
+ThreadPool::ThreadPool(int numThreads): stopping(false) {
+	if(numThreads <= 0)
+		numThreads = thread::hardware_concurrency();
+	if(numThreads <= 0)
+		numThreads = 1;
+	for(int i = 0;i < numThreads;i++)
+		workers.push_back(thread(&ThreadPool::workerLoop, this));
+}
+
+ThreadPool::~ThreadPool(){
+	{
+		unique_lock<mutex> lock(tasksMutex);
+		stopping = true;
+	}
+	tasksAvailable.notify_all();
+	for(size_t i = 0;i < workers.size();i++)
+		workers[i].join();
+}
+
+void ThreadPool::workerLoop(){
+	while(true){
+		function<void()> task;
+		{
+			unique_lock<mutex> lock(tasksMutex);
+			while(!stopping && tasks.empty())
+				tasksAvailable.wait(lock);
+			if(tasks.empty())
+				return;
+			task = tasks.front();
+			tasks.pop();
+		}
+		task();
+	}
+}
+
+/**
+ * Queues a task. The future becomes ready when it finishes and rethrows
+ * whatever the task threw.
+ */
+future<void> ThreadPool::submit(function<void()> task){
+	shared_ptr<packaged_task<void()> > packaged = make_shared<packaged_task<void()> >(task);
+	future<void> result = packaged->get_future();
+	{
+		unique_lock<mutex> lock(tasksMutex);
+		tasks.push([packaged](){ (*packaged)(); });
+	}
+	tasksAvailable.notify_one();
+	return result;
+}
+
+int ThreadPool::size() const {
+	return workers.size();
+}
+
+/**
+ * Pool shared by the whole program, created on first use.
+ */
+ThreadPool& ThreadPool::getDefault(){
+	static ThreadPool pool;
+	return pool;
+}
+
+/**
+ * Waits for every future and then rethrows the first exception, if any task threw.
+ */
+void ThreadPool::waitAll(vector<future<void> >& futures){
+	for(size_t i = 0;i < futures.size();i++)
+		futures[i].wait();
+	vector<future<void> > done;
+	done.swap(futures);
+	for(size_t i = 0;i < done.size();i++)
+		done[i].get();
+}
@@ -0,0 +1,48 @@
+/*
+ * ThreadPool.h
+ */
+
+#ifndef SRC_THREADPOOL_H_
+#define SRC_THREADPOOL_H_
+
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+
+using namespace std;
+
+/**
+ * Fixed set of worker threads that run submitted tasks in FIFO order.
+ * Tasks must not wait on other tasks of the same pool, or the pool may run
+ * out of free workers; submit every piece of work from the caller and wait there.
+ */
+class ThreadPool {
+
+private:
+	vector<thread> workers;
+	queue<function<void()> > tasks;
+	mutex tasksMutex;
+	condition_variable tasksAvailable;
+	bool stopping;
+
+	void workerLoop();
+
+	ThreadPool(const ThreadPool&);
+	ThreadPool& operator=(const ThreadPool&);
+
+public:
+	ThreadPool(int numThreads = 0);
+	virtual ~ThreadPool();
+
+	future<void> submit(function<void()> task);
+	int size() const;
+
+	static ThreadPool& getDefault();
+	static void waitAll(vector<future<void> >& futures);
+};
+
+#endif /* SRC_THREADPOOL_H_ */
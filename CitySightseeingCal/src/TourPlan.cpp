@@ -0,0 +1,65 @@
+/*
+ * TourPlan.cpp
+ */
+
+#include <cstring>
+#include "TourPlan.h"
+#include "MappedFile.h"
+#include "FieldScanner.h"
+#include "FileNotExists.h"
+
+static bool fieldIs(const char* begin, const char* end, const char* word){
+	size_t n = strlen(word);
+	return (size_t)(end - begin) == n && memcmp(begin, word, n) == 0;
+}
+
+void TourPlan::readFromFile(string planFlName){
+	MappedFile fl;
+	if(fl.open(planFlName) == false)
+		throw FileNotExists(planFlName);
+	readFromBuffer(fl.begin(), fl.end());
+}
+
+void TourPlan::readFromBuffer(const char* begin, const char* end){
+	FieldScanner sc(begin, end);
+	const char *b, *e, *fb, *fe;
+
+	while(sc.nextLine()){
+		sc.readField(b, e);
+		if(b < e && *b == '#')
+			continue;
+
+		if(fieldIs(b, e, "map")){
+			sc.readField(fb, fe);
+			if(fb < fe)
+				mapPath = string(fb, fe);
+		}
+		else if(fieldIs(b, e, "bus")){
+			vector<string> pois;
+			while(true){
+				sc.readField(fb, fe);
+				if(fb == fe)
+					break;
+				pois.push_back(string(fb, fe));
+			}
+			if(pois.size() >= 2)
+				buses.push_back(pois);
+		}
+		else if(fieldIs(b, e, "tourist")){
+			PlannedTourist t;
+			sc.readField(fb, fe);
+			t.name = string(fb, fe);
+			sc.readField(b, e);
+			if(fieldIs(b, e, "poi"))
+				t.choice = PlannedTourist::BY_POI;
+			else if(fieldIs(b, e, "with"))
+				t.choice = PlannedTourist::BY_PERSON;
+			else
+				continue;
+			sc.readField(fb, fe);
+			t.query = string(fb, fe);
+			if(!t.name.empty() && !t.query.empty())
+				tourists.push_back(t);
+		}
+	}
+}
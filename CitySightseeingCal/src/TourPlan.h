@@ -0,0 +1,56 @@
+/*
+ * TourPlan.h
+ */
+
+#ifndef SRC_TOURPLAN_H_
+#define SRC_TOURPLAN_H_
+
+#include <vector>
+#include <string>
+
+using namespace std;
+
+/**
+ * Tourist of a plan and how to choose its bus: by a POI the bus goes
+ * through, or by the name of a tourist already placed.
+ */
+struct PlannedTourist {
+	enum Choice { BY_POI, BY_PERSON };
+	string name;
+	Choice choice;
+	string query;			//name of the POI or of the other tourist
+};
+
+/**
+ * Input of the batch mode, one entry per line, fields separated by ';':
+ *
+ *   map;path					(directory with nodes.txt, roads.txt and edges.txt, or a binary map)
+ *   bus;start;end;poi;...		(POIs as node ids or projected coordinates x,y)
+ *   tourist;name;poi;poiName
+ *   tourist;name;with;otherName
+ *
+ * Lines starting with '#' and lines that can not be parsed are ignored.
+ * Without a map line the manual graph of the program is used. Tourists are
+ * placed in file order, as if typed in the interactive mode.
+ */
+class TourPlan {
+
+private:
+	string mapPath;
+	vector<vector<string> > buses;
+	vector<PlannedTourist> tourists;
+
+public:
+	TourPlan(){};
+	virtual ~TourPlan(){};
+
+	void readFromFile(string planFlName);
+	void readFromBuffer(const char* begin, const char* end);
+	void addBus(const vector<string>& pois) { buses.push_back(pois); }
+	void addTourist(const PlannedTourist& tourist) { tourists.push_back(tourist); }
+	const string& getMapPath() const { return mapPath; }
+	const vector<vector<string> >& getBuses() const { return buses; }
+	const vector<PlannedTourist>& getTourists() const { return tourists; }
+};
+
+#endif /* SRC_TOURPLAN_H_ */
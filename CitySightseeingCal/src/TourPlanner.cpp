@@ -0,0 +1,203 @@
+/*
+ * TourPlanner.cpp
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <climits>
+#include "TourPlanner.h"
+#include "DistanceTable.h"
+#include "StringAlgorithms.h"
+
+TourPlanner::TourPlanner(const MapReading& mr):
+		graph(mr.getCompactGraph()), index(mr.getSpatialIndex()), nameOfNodes(mr.getNameOfNodes()) {
+}
+
+/**
+ * Node given by its id, or by coordinates "x,y" snapped to the nearest node.
+ * -1 if it is not a node of the map.
+ */
+int TourPlanner::readPoi(const string& s) const {
+	double x, y;
+	int val;
+	if(s.find(',') != string::npos && sscanf(s.c_str(), "%lf,%lf", &x, &y) == 2)
+		val = index.nearest(x, y);
+	else{
+		char* end;
+		val = strtol(s.c_str(), &end, 10);
+		if(end == s.c_str() || *end != '\0')
+			return -1;
+	}
+	return val >= 0 && val < getNumNodes() ? val : -1;
+}
+
+/**
+ * Tour that starts in pois[0], ends in pois[1] and visits the other POIs in
+ * between (see DistanceTable::getPathSalesmanProblem), already expanded.
+ * The POIs must be valid nodes, at least two of them.
+ */
+Route TourPlanner::planRoute(const vector<int>& pois) const {
+	int k = pois.size();
+	vector<ShortestPaths> searches(k);
+	vector<int> dist(k*k);
+	for(int i = 0;i < k;i++){
+		graph.dijkstraShortestPath(pois[i], searches[i]);
+		for(int j = 0;j < k;j++){
+			double d = graph.getDistance(searches[i], pois[j]);
+			dist[i*k + j] = d < 0 ? INT_MAX : (int) d;
+		}
+	}
+
+	DistanceTable table(pois, dist);
+	Route route(table.getPathSalesmanProblem(0, 1));
+	route.expand(graph, pois, searches);
+	return route;
+}
+
+/**
+ * Bus on the route, knowing the names of all the nodes it goes through.
+ */
+Bus TourPlanner::makeBus(Route&& route) const {
+	Bus bus(std::move(route));
+	const vector<int>& path = bus.getRoute().getNodes();
+	for(size_t j = 0;j < path.size();j++)
+		bus.addPoi(nameOfNodes[path[j]]);
+	return bus;
+}
+
+/**
+ * Nodes of a shortest path from origin to dest, empty if there is none.
+ * dist gets its length, or -1.
+ */
+vector<int> TourPlanner::getShortestPath(int origin, int dest, double& dist) const {
+	ShortestPaths search;
+	graph.dijkstraShortestPath(origin, search);
+	dist = graph.getDistance(search, dest);
+	vector<int> path;
+	if(dist < 0)
+		return path;
+	path.reserve(graph.getPathSize(search, dest));
+	path.push_back(origin);
+	graph.appendPath(search, dest, path);
+	return path;
+}
+
+/**
+ * Plans every bus of the plan, then places the tourists in file order.
+ */
+PlanResult TourPlanner::execute(const TourPlan& plan) const {
+	PlanResult result;
+	const vector<vector<string> >& buses = plan.getBuses();
+	result.pois.resize(buses.size());
+	result.buses.reserve(buses.size());
+	for(size_t i = 0;i < buses.size();i++){
+		bool valid = buses[i].size() >= 2;
+		for(size_t j = 0;j < buses[i].size();j++){
+			result.pois[i].push_back(readPoi(buses[i][j]));
+			valid = valid && result.pois[i].back() != -1;
+		}
+		result.buses.push_back(makeBus(valid ? planRoute(result.pois[i]) : Route()));
+	}
+
+	const vector<PlannedTourist>& tourists = plan.getTourists();
+	result.busOfTourist.assign(tourists.size(), -1);
+	result.matched.resize(tourists.size());
+	for(size_t i = 0;i < tourists.size();i++){
+		Person p(tourists[i].name);
+		if(tourists[i].choice == PlannedTourist::BY_POI)
+			result.busOfTourist[i] = assignByPoi(result.buses, p, tourists[i].query);
+		else
+			result.busOfTourist[i] = assignByPerson(result.buses, p, tourists[i].query, result.matched[i]);
+	}
+	return result;
+}
+
+/**
+ * The result as a JSON object, with the number of nodes of the map. Buses are
+ * numbered from 1 as in the interactive mode; "reachable" is false for the
+ * buses without route.
+ */
+void TourPlanner::writeResult(JsonWriter& w, const TourPlan& plan, PlanResult& result) const {
+	w.beginObject();
+	w.key("nodes"); w.value(getNumNodes());
+	w.key("buses");
+	w.beginArray();
+	for(size_t i = 0;i < result.buses.size();i++){
+		const Route& route = result.buses[i].getRoute();
+		w.beginObject();
+		w.key("bus"); w.value((int) i+1);
+		w.key("pois"); w.values(result.pois[i]);
+		w.key("stops"); w.values(route.getStops());
+		w.key("path"); w.values(route.getNodes());
+		w.key("reachable"); w.value(route.isExpanded());
+		w.key("tourists");
+		w.beginArray();
+		vector<Person> touristsInBus = result.buses[i].getTourists();
+		for(size_t j = 0;j < touristsInBus.size();j++)
+			w.value(touristsInBus[j].getName());
+		w.endArray();
+		w.endObject();
+	}
+	w.endArray();
+
+	const vector<PlannedTourist>& tourists = plan.getTourists();
+	w.key("tourists");
+	w.beginArray();
+	for(size_t i = 0;i < tourists.size();i++){
+		w.beginObject();
+		w.key("name"); w.value(tourists[i].name);
+		w.key("choice"); w.value(tourists[i].choice == PlannedTourist::BY_POI ? "poi" : "with");
+		w.key("query"); w.value(tourists[i].query);
+		if(tourists[i].choice == PlannedTourist::BY_PERSON && result.busOfTourist[i] != -1){
+			w.key("matched"); w.value(result.matched[i]);
+		}
+		w.key("bus");
+		if(result.busOfTourist[i] == -1)
+			w.null();
+		else
+			w.value(result.busOfTourist[i] + 1);
+		w.endObject();
+	}
+	w.endArray();
+	w.endObject();
+}
+
+/**
+ * Places the tourist in the first bus that goes through a POI whose name
+ * contains poi. Returns the index of the bus, or -1 if there is none.
+ */
+int TourPlanner::assignByPoi(vector<Bus>& buses, Person& tourist, const string& poi){
+	for(size_t i = 0;i < buses.size();i++)
+		if(kmp_matcher(buses[i].getPois(), poi) > 0){
+			buses[i].addTourist(tourist);
+			return i;
+		}
+	return -1;
+}
+
+/**
+ * Places the tourist in the bus of the tourist called name or, if there is
+ * no such tourist, of the one with the closest name (edit distance, the first
+ * bus winning ties). matched gets the name used. Returns the index of the
+ * bus, or -1 if no tourist was placed yet.
+ */
+int TourPlanner::assignByPerson(vector<Bus>& buses, Person& tourist, const string& name, string& matched){
+	int best = -1;
+	int bestDist = INT_MAX;
+	for(size_t i = 0;i < buses.size() && bestDist > 0;i++){
+		vector<Person> touristsInBus = buses[i].getTourists();
+		for(size_t j = 0;j < touristsInBus.size();j++){
+			int d = touristsInBus[j].getName() == name ? 0 : editDistance(name, touristsInBus[j].getName());
+			if(d < bestDist){
+				best = i;
+				bestDist = d;
+				matched = touristsInBus[j].getName();
+				if(d == 0)
+					break;
+			}
+		}
+	}
+	if(best != -1)
+		buses[best].addTourist(tourist);
+	return best;
+}
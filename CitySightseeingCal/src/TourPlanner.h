@@ -0,0 +1,68 @@
+/*
+ * TourPlanner.h
+ */
+
+#ifndef SRC_TOURPLANNER_H_
+#define SRC_TOURPLANNER_H_
+
+#include <vector>
+#include <string>
+#include "MapReading.h"
+#include "ContractedGraph.h"
+#include "SpatialIndex.h"
+#include "Route.h"
+#include "Bus.h"
+#include "Person.h"
+#include "TourPlan.h"
+#include "JsonWriter.h"
+
+using namespace std;
+
+/**
+ * Outcome of a TourPlan: the buses in plan order, the POIs of each bus as
+ * nodes (-1 for the ones that are not nodes of the map, in which case the bus
+ * has no route) and the bus of each tourist (-1 if none was found). A bus also
+ * has no route when one of its stops can not be reached from the one before.
+ */
+struct PlanResult {
+	vector<Bus> buses;
+	vector<vector<int> > pois;
+	vector<int> busOfTourist;
+	vector<string> matched;				//name used by the tourists that chose by person
+};
+
+/**
+ * Plans bus tours and places tourists without asking anything, for the batch
+ * mode of main. Instead of Floyd-Warshall over the whole map it runs one
+ * Dijkstra search per POI on the map contracted once at construction (the
+ * POIs need not be kept vertices of it): the searches give the distance
+ * table of the tour and then expand the tour into nodes of the map.
+ *
+ * The planner does not change after construction and keeps the state of every
+ * query on the stack, so one planner may be used by several threads at once.
+ */
+class TourPlanner {
+
+private:
+	ContractedGraph graph;
+	SpatialIndex index;
+	vector<string> nameOfNodes;
+
+public:
+	TourPlanner(const MapReading& mr);
+	virtual ~TourPlanner(){};
+
+	int getNumNodes() const { return graph.getNumOriginalVertex(); }
+	const ContractedGraph& getGraph() const { return graph; }
+	int readPoi(const string& s) const;
+	Route planRoute(const vector<int>& pois) const;
+	Bus makeBus(Route&& route) const;
+	vector<int> getShortestPath(int origin, int dest, double& dist) const;
+	PlanResult execute(const TourPlan& plan) const;
+	void writeResult(JsonWriter& w, const TourPlan& plan, PlanResult& result) const;
+
+	static int assignByPoi(vector<Bus>& buses, Person& tourist, const string& poi);
+	static int assignByPerson(vector<Bus>& buses, Person& tourist, const string& name, string& matched);
+};
+
+#endif /* SRC_TOURPLANNER_H_ */
@@ -0,0 +1,118 @@
+/*
+ * TravelTimeProfiles.cpp
+ */
+
+#include <map>
+#include <sstream>
+#include <algorithm>
+#include <cmath>
+#include "TravelTimeProfiles.h"
+
+TravelTimeProfiles::TravelTimeProfiles(){
+	firstBreakpoint.push_back(0);
+}
+
+void TravelTimeProfiles::readFromFile(istream& ifs){
+	map<vector<pair<int,float> >, int> knownProfiles;
+	string line;
+
+	while(getline(ifs, line)){
+		istringstream iss(line);
+		int idEdge;
+		char pontoVirgula;
+		if(!(iss >> idEdge >> pontoVirgula) || idEdge < 0)
+			continue;
+
+		vector<pair<int,float> > breakpoints;
+		int time;
+		float factor;
+		char virgula;
+		bool valid = true;
+		while(iss >> time >> virgula >> factor){
+			if(time < 0 || factor < 0)
+				valid = false;
+			breakpoints.push_back(pair<int,float>(time % SECONDS_PER_DAY, factor));
+			iss >> pontoVirgula;
+		}
+		if(!valid || breakpoints.empty())
+			continue;
+		sort(breakpoints.begin(), breakpoints.end());
+
+		int profile;
+		map<vector<pair<int,float> >, int>::iterator it = knownProfiles.find(breakpoints);
+		if(it != knownProfiles.end())
+			profile = it->second;
+		else{
+			profile = getNumProfiles();
+			knownProfiles[breakpoints] = profile;
+			for(size_t i = 0;i < breakpoints.size();i++){
+				breakTimes.push_back(breakpoints[i].first);
+				breakFactors.push_back(breakpoints[i].second);
+			}
+			firstBreakpoint.push_back(breakTimes.size());
+		}
+
+		if(idEdge >= (int)profileOfEdge.size())
+			profileOfEdge.resize(idEdge + 1, -1);
+		profileOfEdge[idEdge] = profile;
+	}
+}
+
+/**
+ * Makes room for every edge of the map, the ones without profile travel at free flow.
+ */
+void TravelTimeProfiles::setNumEdges(int numEdges){
+	if(numEdges > (int)profileOfEdge.size())
+		profileOfEdge.resize(numEdges, -1);
+}
+
+int TravelTimeProfiles::getNumProfiles() const {
+	return firstBreakpoint.size() - 1;
+}
+
+bool TravelTimeProfiles::hasProfile(int idEdge) const {
+	return idEdge >= 0 && idEdge < (int)profileOfEdge.size() && profileOfEdge[idEdge] != -1;
+}
+
+/**
+ * Factor of the edge at the given time, interpolated between the surrounding
+ * breakpoints. Profiles repeat every day, so the last breakpoint connects to the first.
+ */
+double TravelTimeProfiles::getFactor(int idEdge, double time) const {
+	if(!hasProfile(idEdge))
+		return 1.0;
+
+	int profile = profileOfEdge[idEdge];
+	int first = firstBreakpoint[profile];
+	int last = firstBreakpoint[profile+1] - 1;
+	if(first == last)
+		return breakFactors[first];
+
+	double t = fmod(time, SECONDS_PER_DAY);
+	if(t < 0)
+		t += SECONDS_PER_DAY;
+
+	int next = upper_bound(breakTimes.begin() + first, breakTimes.begin() + last + 1, t) - breakTimes.begin();
+	int prev;
+	double t0, t1;
+	if(next == first || next > last){
+		prev = last;
+		next = first;
+		t0 = breakTimes[prev];
+		t1 = breakTimes[next] + SECONDS_PER_DAY;
+		if(t < t0)
+			t += SECONDS_PER_DAY;
+	}
+	else{
+		prev = next - 1;
+		t0 = breakTimes[prev];
+		t1 = breakTimes[next];
+	}
+
+	double alpha = (t - t0) / (t1 - t0);
+	return breakFactors[prev] + alpha * (breakFactors[next] - breakFactors[prev]);
+}
+
+double TravelTimeProfiles::getTravelTime(int idEdge, double weight, double departure) const {
+	return weight * getFactor(idEdge, departure);
+}
@@ -0,0 +1,52 @@
+/*
+ * TravelTimeProfiles.h
+ */
+
+#ifndef SRC_TRAVELTIMEPROFILES_H_
+#define SRC_TRAVELTIMEPROFILES_H_
+
+#include <vector>
+#include <string>
+#include <istream>
+
+using namespace std;
+
+/**
+ * Piecewise-linear travel-time profiles of the edges of the map.
+ *
+ * The static weight of an edge is taken as its free-flow travel time and a profile
+ * gives, for each time of the day, the factor by which that time is multiplied.
+ * Every profile lives in the same breakpoint arrays (firstBreakpoint says where each
+ * one starts) and edges with identical breakpoints share a single profile.
+ * Edges without a profile always travel at free flow.
+ *
+ * Side file format, one edge per line, times in seconds after midnight:
+ * idEdge;time,factor;time,factor;...
+ * Lines with a negative edge id, time or factor are ignored.
+ *
+ * Only Graph::timeDependentShortestPath uses the profiles; the tour planning
+ * (interactive, batch and server) still routes on the static weights.
+ */
+class TravelTimeProfiles {
+
+private:
+	vector<int> profileOfEdge;
+	vector<int> firstBreakpoint;
+	vector<int> breakTimes;
+	vector<float> breakFactors;
+
+public:
+	static const int SECONDS_PER_DAY = 86400;
+
+	TravelTimeProfiles();
+	virtual ~TravelTimeProfiles(){};
+
+	void readFromFile(istream& ifs);
+	void setNumEdges(int numEdges);
+	int getNumProfiles() const;
+	bool hasProfile(int idEdge) const;
+	double getFactor(int idEdge, double time) const;
+	double getTravelTime(int idEdge, double weight, double departure) const;
+};
+
+#endif /* SRC_TRAVELTIMEPROFILES_H_ */
@@ -0,0 +1,189 @@
+/*
+ * ViewportStreamer.cpp
+ */
+
+#include <algorithm>
+#include <iterator>
+#include "ViewportStreamer.h"
+
+ViewportStreamer::ViewportStreamer(const vector<pair<double,double> >& nodes, const vector<bool>& removedNodes,
+		const vector<pair<int,int> >& edges, const vector<pair<double,bool> >& properties, const vector<bool>& removed,
+		const vector<long long>& roadOfEdge, int width, int height, size_t maxNodes):
+		position(nodes.size()), edges(edges), properties(properties), firstIncident(nodes.size() + 1, 0),
+		skeletonEdge(edges.size(), false), nodeIndex(nodes, removedNodes), maxNodes(maxNodes), coarse(false), started(false) {
+	double minX = 0, minY = 0, maxX = 0, maxY = 0;
+	bool first = true;
+	for(size_t i = 0;i < nodes.size();i++){
+		if(i < removedNodes.size() && removedNodes[i])
+			continue;
+		if(first || nodes[i].first < minX) minX = nodes[i].first;
+		if(first || nodes[i].second < minY) minY = nodes[i].second;
+		if(first || nodes[i].first > maxX) maxX = nodes[i].first;
+		if(first || nodes[i].second > maxY) maxY = nodes[i].second;
+		first = false;
+	}
+	double scaleX = maxX > minX ? (width - 2*MARGIN) / (maxX - minX) : 0;
+	double scaleY = maxY > minY ? (height - 2*MARGIN) / (maxY - minY) : 0;
+	for(size_t i = 0;i < nodes.size();i++){
+		position[i].first = (nodes[i].first - minX)*scaleX + MARGIN;
+		position[i].second = (nodes[i].second - minY)*scaleY + MARGIN;
+	}
+
+	for(size_t i = 0;i < edges.size();i++)
+		if(i >= removed.size() || !removed[i]){
+			firstIncident[edges[i].first + 1]++;
+			if(edges[i].second != edges[i].first)
+				firstIncident[edges[i].second + 1]++;
+		}
+	for(size_t v = 0;v < nodes.size();v++)
+		firstIncident[v + 1] += firstIncident[v];
+	incident.resize(firstIncident.back());
+	vector<int> next(firstIncident.begin(), firstIncident.end() - 1);
+	for(size_t i = 0;i < edges.size();i++)
+		if(i >= removed.size() || !removed[i]){
+			incident[next[edges[i].first]++] = i;
+			if(edges[i].second != edges[i].first)
+				incident[next[edges[i].second]++] = i;
+		}
+
+	buildSkeleton(roadOfEdge);
+	vector<pair<double,double> > points;
+	for(size_t i = 0;i < skeletonNodes.size();i++)
+		points.push_back(nodes[skeletonNodes[i]]);
+	skeletonIndex = SpatialIndex(points);
+}
+
+/**
+ * Takes the roads from the longest down, skipping those that would bring the
+ * skeleton over maxNodes nodes. Edges without a road count as roads of their own.
+ */
+void ViewportStreamer::buildSkeleton(const vector<long long>& roadOfEdge){
+	vector<pair<long long,int> > byRoad;
+	for(size_t v = 0;v + 1 < firstIncident.size();v++)
+		for(int k = firstIncident[v];k < firstIncident[v + 1];k++){
+			int e = incident[k];
+			if(edges[e].first == (int) v)
+				byRoad.push_back(make_pair(e < (int) roadOfEdge.size() ? roadOfEdge[e] : -1 - (long long) e, e));
+		}
+	sort(byRoad.begin(), byRoad.end());
+
+	vector<pair<double,pair<int,int> > > roads;			//(-length, [begin, end) in byRoad)
+	for(size_t i = 0, j;i < byRoad.size();i = j){
+		double length = 0;
+		for(j = i;j < byRoad.size() && byRoad[j].first == byRoad[i].first;j++)
+			length += properties[byRoad[j].second].first;
+		roads.push_back(make_pair(-length, make_pair(i, j)));
+	}
+	sort(roads.begin(), roads.end());
+
+	vector<bool> inSkeleton(position.size(), false);
+	vector<int> added;
+	for(size_t r = 0;r < roads.size();r++){
+		added.clear();
+		for(int i = roads[r].second.first;i < roads[r].second.second;i++){
+			const pair<int,int>& edge = edges[byRoad[i].second];
+			int ends[2] = { edge.first, edge.second };
+			for(int k = 0;k < 2;k++)
+				if(!inSkeleton[ends[k]]){
+					inSkeleton[ends[k]] = true;
+					added.push_back(ends[k]);
+				}
+		}
+		if(skeletonNodes.size() + added.size() > maxNodes){
+			for(size_t k = 0;k < added.size();k++)
+				inSkeleton[added[k]] = false;
+			continue;
+		}
+		skeletonNodes.insert(skeletonNodes.end(), added.begin(), added.end());
+		for(int i = roads[r].second.first;i < roads[r].second.second;i++)
+			skeletonEdge[byRoad[i].second] = true;
+	}
+	sort(skeletonNodes.begin(), skeletonNodes.end());
+}
+
+/**
+ * Shows the part of the map inside the rectangle, removing what left it and
+ * adding what entered it, and flushes the viewer.
+ * Returns the number of nodes and edges added or removed.
+ */
+int ViewportStreamer::setViewport(GraphViewer *gv, double minX, double minY, double maxX, double maxY){
+	vector<int> inside;
+	coarse = nodeIndex.countInRect(minX, minY, maxX, maxY, maxNodes + 1) > maxNodes;
+	if(coarse){
+		vector<int> found = skeletonIndex.inRect(minX, minY, maxX, maxY);
+		for(size_t i = 0;i < found.size();i++)
+			inside.push_back(skeletonNodes[found[i]]);
+		sort(inside.begin(), inside.end());
+	}
+	else
+		inside = nodeIndex.inRect(minX, minY, maxX, maxY);
+
+	vector<int> nodesNow(inside), edgesNow;
+	for(size_t i = 0;i < inside.size();i++)
+		for(int k = firstIncident[inside[i]];k < firstIncident[inside[i] + 1];k++){
+			int e = incident[k];
+			if(coarse && !skeletonEdge[e])
+				continue;
+			edgesNow.push_back(e);
+			nodesNow.push_back(edges[e].first);
+			nodesNow.push_back(edges[e].second);
+		}
+	sort(edgesNow.begin(), edgesNow.end());
+	edgesNow.erase(unique(edgesNow.begin(), edgesNow.end()), edgesNow.end());
+	sort(nodesNow.begin(), nodesNow.end());
+	nodesNow.erase(unique(nodesNow.begin(), nodesNow.end()), nodesNow.end());
+
+	vector<int> removedEdges, removedNodes, addedNodes, addedEdges;
+	set_difference(shownEdges.begin(), shownEdges.end(), edgesNow.begin(), edgesNow.end(), back_inserter(removedEdges));
+	set_difference(shownNodes.begin(), shownNodes.end(), nodesNow.begin(), nodesNow.end(), back_inserter(removedNodes));
+	set_difference(nodesNow.begin(), nodesNow.end(), shownNodes.begin(), shownNodes.end(), back_inserter(addedNodes));
+	set_difference(edgesNow.begin(), edgesNow.end(), shownEdges.begin(), shownEdges.end(), back_inserter(addedEdges));
+
+	if(!started){
+		gv->defineVertexSize(VERTEX_SIZE);
+		started = true;
+	}
+	for(size_t i = 0;i < removedEdges.size();i++)
+		gv->removeEdge(removedEdges[i]);
+	for(size_t i = 0;i < removedNodes.size();i++)
+		gv->removeNode(removedNodes[i]);
+	for(size_t i = 0;i < addedNodes.size();i++){
+		int v = addedNodes[i];
+		gv->addNode(v, position[v].first, position[v].second);
+	}
+	for(size_t i = 0;i < addedEdges.size();i++){
+		int e = addedEdges[i];
+		gv->addEdge(e, edges[e].first, edges[e].second, properties[e].second ? EdgeType::UNDIRECTED : EdgeType::DIRECTED);
+		gv->setEdgeFlow(e, properties[e].first);
+	}
+	gv->flush();
+
+	shownNodes.swap(nodesNow);
+	shownEdges.swap(edgesNow);
+	return removedEdges.size() + removedNodes.size() + addedNodes.size() + addedEdges.size();
+}
+
+/**
+ * Removes everything shown. Returns the number of nodes and edges removed.
+ */
+int ViewportStreamer::clear(GraphViewer *gv){
+	int res = shownNodes.size() + shownEdges.size();
+	for(size_t i = 0;i < shownEdges.size();i++)
+		gv->removeEdge(shownEdges[i]);
+	for(size_t i = 0;i < shownNodes.size();i++)
+		gv->removeNode(shownNodes[i]);
+	gv->flush();
+	shownNodes.clear();
+	shownEdges.clear();
+	return res;
+}
+
+/**
+ * Forgets what was shown, for when the viewer was redrawn from scratch.
+ */
+void ViewportStreamer::reset(){
+	shownNodes.clear();
+	shownEdges.clear();
+	coarse = false;
+	started = false;
+}
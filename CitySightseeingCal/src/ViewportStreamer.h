@@ -0,0 +1,73 @@
+/*
+ * ViewportStreamer.h
+ */
+
+#ifndef SRC_VIEWPORTSTREAMER_H_
+#define SRC_VIEWPORTSTREAMER_H_
+
+#include <vector>
+#include "graphviewer.h"
+#include "SpatialIndex.h"
+
+using namespace std;
+
+/**
+ * Level of detail for maps too large to send to the viewer at once. Only the
+ * nodes inside the viewport, a rectangle in the projected coordinates of
+ * MapReading::getNodes, are sent, with the edges that touch them and the
+ * nodes at their other ends, so roads are not cut at the border. Nodes and
+ * edges removed by a diff are never sent.
+ *
+ * When the viewport holds more than maxNodes nodes only the skeleton of the
+ * map is drawn: the edges of the longest roads, taken while they have at most
+ * maxNodes nodes in all. The map has no road classes, so the total length of
+ * a road stands for its importance.
+ *
+ * setViewport only sends the difference to what is already shown. Nodes and
+ * edges keep their ids in the map and the whole map is scaled to the canvas
+ * once, like MapReading::sendDataToGraphViewer, so nothing ever moves.
+ */
+class ViewportStreamer {
+
+public:
+	static const size_t DEFAULT_MAX_NODES = 2000;
+	static const int VERTEX_SIZE = 5;
+	static const int MARGIN = 25;
+
+private:
+	vector<pair<int,int> > position;			//on the canvas
+	vector<pair<int,int> > edges;
+	vector<pair<double,bool> > properties;
+	vector<int> firstIncident;					//edges of node v: incident[firstIncident[v]..firstIncident[v+1])
+	vector<int> incident;
+	vector<bool> skeletonEdge;
+	vector<int> skeletonNodes;					//node of each point of skeletonIndex
+	SpatialIndex nodeIndex;
+	SpatialIndex skeletonIndex;
+	size_t maxNodes;
+
+	vector<int> shownNodes;						//sorted
+	vector<int> shownEdges;						//sorted
+	bool coarse;
+	bool started;
+
+	void buildSkeleton(const vector<long long>& roadOfEdge);
+
+public:
+	ViewportStreamer(): maxNodes(DEFAULT_MAX_NODES), coarse(false), started(false) {};
+	ViewportStreamer(const vector<pair<double,double> >& nodes, const vector<bool>& removedNodes,
+			const vector<pair<int,int> >& edges, const vector<pair<double,bool> >& properties, const vector<bool>& removed,
+			const vector<long long>& roadOfEdge, int width, int height, size_t maxNodes = DEFAULT_MAX_NODES);
+	virtual ~ViewportStreamer(){};
+
+	int setViewport(GraphViewer *gv, double minX, double minY, double maxX, double maxY);
+	int clear(GraphViewer *gv);
+	void reset();
+
+	bool isCoarse() const { return coarse; }
+	size_t getNumShownNodes() const { return shownNodes.size(); }
+	size_t getNumShownEdges() const { return shownEdges.size(); }
+	size_t getSkeletonSize() const { return skeletonNodes.size(); }
+};
+
+#endif /* SRC_VIEWPORTSTREAMER_H_ */
@@ -5,70 +5,235 @@ void myerror(string msg) {
   exit(-1);
 }
 
-Connection::Connection(short port) {
 #ifdef linux
+/* a closed peer makes send fail instead of raising SIGPIPE */
+static const int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+static const int SEND_FLAGS = 0;
+#endif
+
+Connection::Connection(short port, int timeoutMs):
+    closed(false), batching(false), fireAndForget(false), inBuffer(READ_BUFFER_SIZE),
+    inBegin(0), inEnd(0), pendingAcks(0), failedAcks(0) {
   struct sockaddr_in echoServAddr; /* Echo server address */
-  struct  hostent  *ptrh;
-  
-  /* Create a reliable, stream socket using TCP */
-  if ((sock = socket(AF_INET, SOCK_STREAM, 0)) < 0)
-    myerror("socket() failed");
-  
+
   /* Construct the server address structure */
   memset(&echoServAddr, 0, sizeof(echoServAddr));     /* Zero out structure */
   echoServAddr.sin_family      = AF_INET;             /* Internet address family */
   echoServAddr.sin_port = htons(port);                /* Server port */
+#ifdef linux
+  struct  hostent  *ptrh;
 
   ptrh = gethostbyname("localhost");
+  if (ptrh == NULL)
+    myerror("gethostbyname() failed");
 
   memcpy(&echoServAddr.sin_addr, ptrh->h_addr, ptrh->h_length);
-  
-  /* Establish the connection to the echo server */
-  if (connect(sock, (struct sockaddr *) &echoServAddr, sizeof(echoServAddr)) < 0)
-    myerror("connect() failed");
 #else
-		WSADATA wsaData;
-    int iResult = WSAStartup(MAKEWORD(2,2), &wsaData);
-    if (iResult != NO_ERROR)
-				printf("Client: Error at WSAStartup().\n");
-
-	// Create a socket.
-    sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
-    if (sock == INVALID_SOCKET) {
-        printf("Client: socket() - Error at socket(): %ld\n", WSAGetLastError());
-        WSACleanup();
-    }
+  WSADATA wsaData;
+  if (WSAStartup(MAKEWORD(2,2), &wsaData) != NO_ERROR)
+    myerror("Client: Error at WSAStartup().");
 
-    // Connect to a server.
-    sockaddr_in clientService;
-    clientService.sin_family = AF_INET;
-    // Just test using the localhost, you can try other IP address
-    clientService.sin_addr.s_addr = inet_addr("127.0.0.1");
-    clientService.sin_port = htons(port);
+  echoServAddr.sin_addr.s_addr = inet_addr("127.0.0.1");
+#endif
 
-    if (connect(sock, (SOCKADDR*)&clientService, sizeof(clientService)) == SOCKET_ERROR) {
-        printf("Client: connect() - Failed to connect.\n");
-        WSACleanup();
+  /* The viewer may still be starting: retry with exponential backoff until
+     it listens or the timeout expires */
+  chrono::steady_clock::time_point deadline =
+      chrono::steady_clock::now() + chrono::milliseconds(timeoutMs);
+  int delayMs = CONNECT_FIRST_DELAY_MS;
+  int error = 0;
+  while (!tryConnect(echoServAddr, error)) {
+    if (chrono::steady_clock::now() >= deadline) {
+      char buff[200];
+      sprintf(buff, "connect() to port %d failed after %d ms (error %d)", (int) port, timeoutMs, error);
+      myerror(buff);
     }
+    this_thread::sleep_for(chrono::milliseconds(delayMs));
+    delayMs *= 2;
+    if (delayMs > CONNECT_MAX_DELAY_MS)
+      delayMs = CONNECT_MAX_DELAY_MS;
+  }
+}
+
+/* One connection attempt. On failure the socket is closed and error holds
+   the system error code. */
+bool Connection::tryConnect(const struct sockaddr_in& addr, int& error) {
+#ifdef linux
+  /* Create a reliable, stream socket using TCP */
+  if ((sock = socket(AF_INET, SOCK_STREAM, 0)) < 0)
+    myerror("socket() failed");
+
+  /* Establish the connection to the echo server */
+  if (connect(sock, (struct sockaddr *) &addr, sizeof(addr)) == 0)
+    return true;
+  error = errno;
+  close(sock);
+#else
+  sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+  if (sock == INVALID_SOCKET)
+    myerror("Client: socket() - Error at socket().");
+
+  if (connect(sock, (SOCKADDR*) &addr, sizeof(addr)) != SOCKET_ERROR)
+    return true;
+  error = WSAGetLastError();
+  closesocket(sock);
+#endif
+  return false;
+}
+
+/* Sends what is still queued, then wakes the reader thread by shutting the
+   socket down before closing it. */
+Connection::~Connection() {
+  flush();
+#ifdef linux
+  shutdown(sock, SHUT_RDWR);
+#else
+  shutdown(sock, SD_BOTH);
+#endif
+  if (reader.joinable())
+    reader.join();
+#ifdef linux
+  close(sock);
+#else
+  closesocket(sock);
 #endif
 }
 
 bool Connection::sendMsg(string msg) {
-  int res = send(sock, msg.c_str(), msg.size(), 0);
-  if (res < 0) 
-    myerror("Unable to send");
-  string answer = readLine();
-  return answer == "ok";
+  if (closed)
+    return false;
+  if (!reader.joinable()) {
+    if (!writeAll(msg.data(), msg.size()))
+      return false;
+    string answer;
+    return readLine(answer) && answer == "ok";
+  }
+
+  /* once the reader thread runs it owns the socket input, so a message sent
+     outside batching mode is a batch of one */
+  {
+    lock_guard<mutex> lock(ackMutex);
+    pendingAcks++;
+  }
+  outBuffer += msg;
+  if (!batching)
+    return flush();
+  if (outBuffer.size() >= BATCH_BUFFER_SIZE) {
+    bool res = writeAll(outBuffer.data(), outBuffer.size());
+    outBuffer.clear();
+    return res;
+  }
+  return true;
 }
 
-string Connection::readLine() {
-  string msg;  
-  char ch;
-  while (true) {
-    recv(sock, &ch, 1, 0);
-    if (ch == '\n')
+void Connection::setBatching(bool batching, bool fireAndForget) {
+  flush();
+  this->batching = batching;
+  this->fireAndForget = batching && fireAndForget;
+  if (batching && !reader.joinable())
+    reader = thread(&Connection::readAcks, this);
+}
+
+bool Connection::isBatching() const {
+  return batching;
+}
+
+bool Connection::isOpen() const {
+  return !closed;
+}
+
+/* Writes the queued messages and, unless in fire-and-forget mode, waits for
+   all their replies. False if the connection is closed or any reply since the
+   last wait was not "ok". */
+bool Connection::flush() {
+  bool ok = true;
+  if (!outBuffer.empty()) {
+    ok = writeAll(outBuffer.data(), outBuffer.size());
+    outBuffer.clear();
+  }
+  if (!reader.joinable() || fireAndForget)
+    return ok && !closed;
+
+  unique_lock<mutex> lock(ackMutex);
+  while (pendingAcks > 0 && !closed)
+    ackDone.wait(lock);
+  if (closed) {
+    failedAcks += pendingAcks;
+    pendingAcks = 0;
+  }
+  ok = ok && failedAcks == 0 && !closed;
+  failedAcks = 0;
+  return ok;
+}
+
+bool Connection::writeAll(const char *data, size_t size) {
+  while (size > 0 && !closed) {
+    int res = send(sock, data, size, SEND_FLAGS);
+    if (res < 0) {
+#ifdef linux
+      if (errno == EINTR)
+        continue;
+#endif
+      closed = true;
       break;
-    msg.push_back(ch);
+    }
+    data += res;
+    size -= res;
+  }
+  return size == 0;
+}
+
+bool Connection::readLine(string& line) {
+  line.clear();
+  while (true) {
+    const char *begin = &inBuffer[0] + inBegin, *end = &inBuffer[0] + inEnd;
+    const char *newline = (const char *) memchr(begin, '\n', end - begin);
+    if (newline != NULL) {
+      line.append(begin, newline);
+      inBegin += newline - begin + 1;
+      return true;
+    }
+    line.append(begin, end);
+    inBegin = inEnd = 0;
+    if (closed)
+      return false;
+
+    int res = recv(sock, &inBuffer[0], inBuffer.size(), 0);
+    if (res > 0) {
+      inEnd = res;
+      continue;
+    }
+#ifdef linux
+    if (res < 0 && errno == EINTR)
+      continue;
+#endif
+    closed = true;
+    return false;
   }
+}
+
+string Connection::readLine() {
+  string msg;
+  readLine(msg);
   return msg;
 }
+
+/* Body of the reader thread: every line received answers the oldest message
+   still pending. When the stream ends all pending messages fail. */
+void Connection::readAcks() {
+  string answer;
+  while (readLine(answer)) {
+    lock_guard<mutex> lock(ackMutex);
+    if (answer != "ok")
+      failedAcks++;
+    if (pendingAcks > 0)
+      pendingAcks--;
+    if (pendingAcks == 0)
+      ackDone.notify_all();
+  }
+  lock_guard<mutex> lock(ackMutex);
+  failedAcks += pendingAcks;
+  pendingAcks = 0;
+  ackDone.notify_all();
+}
@@ -10,27 +10,75 @@
 #include <sys/socket.h>
 #include <sys/types.h>
 #include <netdb.h>
+#include <unistd.h>
+#include <cerrno>
 #else
 #include <winsock2.h>
 #endif
 
 #include <string>
 #include <iostream>
+#include <chrono>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 using namespace std;
 
 class Connection {
  public:
-  Connection(short port);
+  static const size_t BATCH_BUFFER_SIZE = 1 << 16;
+  static const size_t READ_BUFFER_SIZE = 1 << 16;
+  static const int CONNECT_TIMEOUT_MS = 30000;
+  static const int CONNECT_FIRST_DELAY_MS = 10;
+  static const int CONNECT_MAX_DELAY_MS = 250;
 
+  /* Connects to the viewer on localhost, retrying until it accepts or
+     timeoutMs have passed; the process exits with an error on timeout. */
+  Connection(short port, int timeoutMs = CONNECT_TIMEOUT_MS);
+  ~Connection();
+
+  /* False if the message could not be written, or if the reply was not "ok".
+     Once the peer has closed the connection every call fails at once. */
   bool sendMsg(string msg);
+
+  /* Reads the next line, without the '\n', through a buffer filled by large
+     reads. False on end of stream or error, with the partial line read. */
+  bool readLine(string& line);
   string readLine();
+  bool isOpen() const;
+
+  /* In batching mode sendMsg only queues the message: the queue is written in
+     chunks of BATCH_BUFFER_SIZE bytes and the "ok" replies are read by a
+     background thread. flush() writes what is left and waits for every reply,
+     unless fireAndForget is set, in which case failed replies are only reported
+     by the next flush that waits. */
+  void setBatching(bool batching, bool fireAndForget = false);
+  bool isBatching() const;
+  bool flush();
  private: 
+  bool tryConnect(const struct sockaddr_in& addr, int& error);
+  bool writeAll(const char *data, size_t size);
+  void readAcks();
+
 #ifdef linux
   int sock;
 #else
   SOCKET sock;
 #endif
+  atomic<bool> closed;
+  bool batching;
+  bool fireAndForget;
+  string outBuffer;
+  vector<char> inBuffer;
+  size_t inBegin, inEnd;
+  thread reader;
+  mutex ackMutex;
+  condition_variable ackDone;
+  size_t pendingAcks;
+  size_t failedAcks;
 };
 
 #endif
@@ -1,10 +1,10 @@
 #include "graphviewer.h"
+#include "SocketRenderer.h"
+#include "HeadlessRenderer.h"
+#include "AsyncRenderer.h"
 #include <string>
-#include<sstream>
+#include <iostream>
 
-#ifdef linux
-pid_t GraphViewer::procId = NULL;
-#endif
 short GraphViewer::port = 7772;
 
 GraphViewer::GraphViewer(int width, int height, bool dynamic) {
@@ -16,81 +16,35 @@ GraphViewer::GraphViewer(int width, int height, bool dynamic, int port_n) {
 	initialize(width, height, dynamic, port_n);
 }
 
-void GraphViewer::initialize(int width, int height, bool dynamic, int port_n) {
+GraphViewer::GraphViewer(int width, int height, bool dynamic, GraphRenderer *renderer) {
 	this->width = width;
 	this->height = height;
 	this->isDynamic = dynamic;
-	string command = "java -jar GraphViewerController.jar";
-	std::stringstream ss;
-	ss << port_n;
-	string port_string = ss.str();
-	command += " --port ";
-	command += port_string;
-
-#ifdef linux
-	if (!(procId = fork())) {
-		system(command.c_str());
-		kill(getppid(), SIGINT);
-		exit(0);
-	}
-	else {
-		usleep(2000000);
-		con = new Connection(port_n);
-
-		char buff[200];
-		sprintf(buff, "newGraph %d %d %s\n", width, height, (dynamic?"true":"false"));
-		string str(buff);
-		con->sendMsg(str);
-	}
-#else
-	STARTUPINFO si;
-	PROCESS_INFORMATION pi;
-	ZeroMemory( &si, sizeof(si) );
-	si.cb = sizeof(si);
-	ZeroMemory( &pi, sizeof(pi) );
-	LPSTR command_lpstr = const_cast<char *>(command.c_str());
-	if( !CreateProcess( NULL,   // No module name (use command line)
-			command_lpstr,        // Command line
-			NULL,           // Process handle not inheritable
-			NULL,           // Thread handle not inheritable
-			FALSE,          // Set handle inheritance to FALSE
-			0,              // No creation flags
-			NULL,           // Use parent's environment block
-			NULL,           // Use parent's starting directory
-			&si,            // Pointer to STARTUPINFO structure
-			&pi )           // Pointer to PROCESS_INFORMATION structure
-	) {
-		cerr << "CreateProcess failed " << GetLastError() << endl;
-		return;
-	}
-
-	// Close process and thread handles.
-	CloseHandle( pi.hProcess );
-	CloseHandle( pi.hThread );
+	this->renderer = renderer;
+}
 
-	Sleep(2000);
-	con = new Connection(port_n);
+GraphViewer::~GraphViewer() {
+	delete renderer;
+}
 
-	char buff[200];
-	sprintf(buff, "newGraph %d %d %s\n", width, height, (dynamic?"true":"false"));
-	string str(buff);
-	con->sendMsg(str);
-#endif
+void GraphViewer::initialize(int width, int height, bool dynamic, int port_n) {
+	this->width = width;
+	this->height = height;
+	this->isDynamic = dynamic;
 
+	const char *output = getenv("GRAPHVIEWER_OUTPUT");
+	if (output != NULL && *output != '\0')
+		renderer = new HeadlessRenderer(width, height, output);
+	else
+		renderer = new SocketRenderer(width, height, dynamic, port_n);
 }
 
 bool GraphViewer::createWindow(int width, int height) {
-	char buff[200];
-	sprintf(buff, "createWindow %d %d\n", width, height);
-	string str(buff);
-	return con->sendMsg(str);
+	return renderer->createWindow(width, height);
 }
 
 bool GraphViewer::closeWindow() {
-	char buff[200];
-	sprintf(buff, "closeWindow\n");
-	string str(buff);
-	return con->sendMsg(str);
+	return renderer->closeWindow();
 }
 
 bool GraphViewer::addNode(int id) {
@@ -102,11 +56,7 @@ bool GraphViewer::addNode(int id) {
 		return false;
 	}
 
-
-	char buff[200];
-	sprintf(buff, "addNode1 %d\n", id);
-	string str(buff);
-	return con->sendMsg(str);
+	return renderer->addNode(id);
 }
 
 bool GraphViewer::addNode(int id, int x, int y) {
@@ -116,152 +66,108 @@ bool GraphViewer::addNode(int id, int x, int y) {
 				<< id << " will be ignored" << endl;
 	}
 
-	char buff[200];
-	sprintf(buff, "addNode3 %d %d %d\n", id, x, y);
-	string str(buff);
-	return con->sendMsg(str);
+	return renderer->addNode(id, x, y);
 }
 
 bool GraphViewer::addEdge(int id, int v1, int v2, int edgeType) {
-	char buff[200];
-	sprintf(buff, "addEdge %d %d %d %d\n", id, v1, v2, edgeType);
-	string str(buff);
-	return con->sendMsg(str);
+	return renderer->addEdge(id, v1, v2, edgeType);
 }
 
 bool GraphViewer::setEdgeLabel(int k, string label) {
-	char buff[200];
-	sprintf(buff, "setEdgeLabel %d %s\n", k, label.c_str());
-	string str(buff);
-	return con->sendMsg(str);
+	return renderer->setEdgeLabel(k, label);
 }
 
 bool GraphViewer::setVertexLabel(int k, string label) {
-	char buff[200];
-	sprintf(buff, "setVertexLabel %d %s\n", k, label.c_str());
-	string str(buff);
-	return con->sendMsg(str);
+	return renderer->setVertexLabel(k, label);
 }
 
 bool GraphViewer::defineEdgeColor(string color) {
-	char buff[200];
-	sprintf(buff, "defineEdgeColor %s\n", color.c_str());
-	string str(buff);
-	return con->sendMsg(str);
+	return renderer->defineEdgeColor(color);
 }
 
 bool GraphViewer::removeNode(int id) {
-	char buff[200];
-	sprintf(buff, "removeNode %d\n", id);
-	string str(buff);
-	return con->sendMsg(str);
+	return renderer->removeNode(id);
 }
 
 bool GraphViewer::removeEdge(int id) {
-	char buff[200];
-	sprintf(buff, "removeEdge %d\n", id);
-	string str(buff);
-	return con->sendMsg(str);
+	return renderer->removeEdge(id);
 }
 
 bool GraphViewer::setEdgeColor(int k, string color) {
-	char buff[200];
-	sprintf(buff, "setEdgeColor %d %s\n", k, color.c_str());
-	string str(buff);
-	return con->sendMsg(str);
+	return renderer->setEdgeColor(k, color);
 }
 
 bool GraphViewer::defineEdgeDashed(bool dashed) {
-	char buff[200];
-	sprintf(buff, "defineEdgeDashed %s\n", dashed? "true" : "false");
-	string str(buff);
-	return con->sendMsg(str);
+	return renderer->defineEdgeDashed(dashed);
 }
 
 bool GraphViewer::setEdgeDashed(int k, bool dashed) {
-	char buff[200];
-	sprintf(buff, "setEdgeDashed %d %s\n", k, dashed? "true" : "false");
-	string str(buff);
-	return con->sendMsg(str);
+	return renderer->setEdgeDashed(k, dashed);
 }
 
 bool GraphViewer::defineEdgeCurved(bool curved) {
-	char buff[200];
-	sprintf(buff, "defineEdgeCurved %s\n", curved? "true" : "false");
-	string str(buff);
-	return con->sendMsg(str);
+	return renderer->defineEdgeCurved(curved);
 }
 
 bool GraphViewer::setEdgeThickness(int k, int thickness) {
-	char buff[200];
-	sprintf(buff, "setEdgeThickness %d %d\n", k, thickness);
-	string str(buff);
-	return con->sendMsg(str);
+	return renderer->setEdgeThickness(k, thickness);
 }
 
 bool GraphViewer::defineVertexColor(string color) {
-	char buff[200];
-	sprintf(buff, "defineVertexColor %s\n", color.c_str());
-	string str(buff);
-	return con->sendMsg(str);
+	return renderer->defineVertexColor(color);
 }
 
 bool GraphViewer::setVertexColor(int k, string color) {
-	char buff[200];
-	sprintf(buff, "setVertexColor %d %s\n", k, color.c_str());
-	string str(buff);
-	return con->sendMsg(str);
+	return renderer->setVertexColor(k, color);
 }
 
 bool GraphViewer::defineVertexIcon(string filepath) {
-	char buff[200];
-	sprintf(buff, "defineVertexIcon %s\n", filepath.c_str());
-	string str(buff);
-	return con->sendMsg(str);
+	return renderer->defineVertexIcon(filepath);
 }
 
 bool GraphViewer::setVertexIcon(int k, string filepath) {
-	char buff[200];
-	sprintf(buff, "setVertexIcon %d %s\n", k, filepath.c_str());
-	string str(buff);
-	return con->sendMsg(str);
+	return renderer->setVertexIcon(k, filepath);
 }
 
 bool GraphViewer::defineVertexSize(int size) {
-	char buff[200];
-	sprintf(buff, "defineVertexSize %d\n", size);
-	string str(buff);
-	return con->sendMsg(str);
+	return renderer->defineVertexSize(size);
 }
 
 bool GraphViewer::setVertexSize(int k, int size) {
-	char buff[200];
-	sprintf(buff, "setVertexSize %d %d\n", k, size);
-	string str(buff);
-	return con->sendMsg(str);
+	return renderer->setVertexSize(k, size);
 }
 
 bool GraphViewer::setBackground(string path) {
-	char buff[200];
-	sprintf(buff, "setBackground %s\n", path.c_str());
-	string str(buff);
-	return con->sendMsg(str);
+	return renderer->setBackground(path);
 }
 
 bool GraphViewer::setEdgeWeight(int id, int weight) {
-	char buff[200];
-	sprintf(buff, "setEdgeWeight %d %d\n", id, weight);
-	string str(buff);
-	return con->sendMsg(str);
+	return renderer->setEdgeWeight(id, weight);
 }
 
 bool GraphViewer::setEdgeFlow(int id, int flow) {
-	char buff[200];
-	sprintf(buff, "setEdgeFlow %d %d\n", id, flow);
-	string str(buff);
-	return con->sendMsg(str);
+	return renderer->setEdgeFlow(id, flow);
 }
 
 bool GraphViewer::rearrange() {
-	return con->sendMsg("rearrange\n");
+	bool res = renderer->rearrange();
+	return flush() && res;
+}
+
+void GraphViewer::setBatching(bool batching, bool fireAndForget) {
+	renderer->setBatching(batching, fireAndForget);
+}
+
+bool GraphViewer::flush() {
+	return renderer->flush();
+}
+
+void GraphViewer::setAsync(bool async) {
+	AsyncRenderer *current = dynamic_cast<AsyncRenderer *>(renderer);
+	if (async && current == NULL)
+		renderer = new AsyncRenderer(renderer);
+	else if (!async && current != NULL) {
+		renderer = current->release();
+		delete current;
+	}
 }
@@ -13,7 +13,7 @@
 #include <string>
 
 #include "edgetype.h"
-#include "connection.h"
+#include "GraphRenderer.h"
 
 #define BLUE "BLUE"
 #define RED "RED"
@@ -32,6 +32,11 @@
 /**
  * Classe que guarda o grafo e o representa. Todas as suas funções retornam um booleano a indicar
  * se a sua execução decorreu ou não com sucesso.
+ *
+ * O desenho é feito por um GraphRenderer. Por omissão é o visualizador em Java (SocketRenderer);
+ * se a variável de ambiente GRAPHVIEWER_OUTPUT tiver o caminho de um ficheiro, o grafo é
+ * desenhado sem janela nem processo filho (HeadlessRenderer), em SVG ou, se o ficheiro
+ * terminar em .dot ou .gv, em Graphviz DOT.
  */
 class GraphViewer {
 public:
@@ -69,6 +74,23 @@ public:
 	 */
 	GraphViewer(int width, int height, bool dynamic, int port_n);
 
+	/**
+	 * Construtor que cria um novo grafo desenhado pelo renderer dado, que passa a pertencer
+	 * ao GraphViewer.
+	 * Exemplo: GraphViewer *gv = new GraphViewer(600, 600, false, new HeadlessRenderer(600, 600, "mapa.svg"));
+	 *
+	 * @param width Inteiro que representa a lagura da área do grafo.
+	 * @param height Inteiro que representa a altura da área do grafo.
+	 * @param dynamic Booleano que determina se a localização dos nós é automaticamente.
+	 * determinado pelo programa (true) ou se deve ser determinado pelo utilizador (false).
+	 * @param renderer Backend que desenha o grafo.
+	 */
+	GraphViewer(int width, int height, bool dynamic, GraphRenderer *renderer);
+
+	GraphViewer(const GraphViewer& other) = delete;
+	GraphViewer& operator=(const GraphViewer& other) = delete;
+	virtual ~GraphViewer();
+
 	/**
 	 * Função que cria a janela para visualização.
 	 * Exemplo, para um apontador gv onde foi instanciada a classe GraphViewer:
@@ -313,15 +335,41 @@ public:
 	 */
 	bool rearrange();
 
-#ifdef linux
-	static pid_t procId;
-#endif
+	/**
+	 * Função que liga ou desliga o modo de envio em lote. Neste modo os comandos são
+	 * guardados e enviados em blocos, e as confirmações do visualizador são lidas em
+	 * paralelo, pelo que as funções acima retornam logo true e os erros só são
+	 * conhecidos em flush(). Exemplo: gv->setBatching(true); antes de enviar um mapa grande.
+	 *
+	 * @param batching Booleano que liga (true) ou desliga (false) o modo de envio em lote.
+	 * @param fireAndForget Booleano que, se true, faz com que flush() não espere pelas
+	 * confirmações do visualizador.
+	 */
+	void setBatching(bool batching, bool fireAndForget = false);
+
+	/**
+	 * Função que envia todos os comandos guardados no modo de envio em lote e espera
+	 * pelas respectivas confirmações. rearrange() chama esta função.
+	 */
+	bool flush();
+
+	/**
+	 * Função que liga ou desliga o modo assíncrono. Neste modo os comandos são postos numa
+	 * fila sem bloqueios e enviados por uma thread própria (AsyncRenderer), pelo que nenhuma
+	 * função espera pelo visualizador; mudanças repetidas da mesma propriedade de um nó ou
+	 * aresta são agrupadas e só a última é enviada. Ao desligar, ou ao destruir o GraphViewer,
+	 * todos os comandos em fila são enviados.
+	 * Exemplo: gv->setAsync(true); antes de calcular e colorir os percursos.
+	 *
+	 * @param async Booleano que liga (true) ou desliga (false) o modo assíncrono.
+	 */
+	void setAsync(bool async);
 
 private:
 	int width, height;
 	bool isDynamic;
 
-	Connection *con;
+	GraphRenderer *renderer;
 
 	void initialize(int, int, bool, int);
 };
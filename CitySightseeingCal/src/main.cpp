@@ -10,18 +10,27 @@
 #include "Person.h"
 #include "MapReading.h"
 #include "Bus.h"
+#include "Route.h"
 #include "StringAlgorithms.h"
+#include "DistanceTable.h"
+#include "EdgeIndex.h"
+#include "EdgeColoring.h"
+#include "TourPlan.h"
+#include "TourPlanner.h"
+#include "JsonWriter.h"
+#include "InvalidMapFormat.h"
+#include "QueryServer.h"
 
-Graph<int> createGraphUsingPois(vector<int>& poisV, vector<vector<int> >& W);
 long int calcDistOfPath(vector<int> path, vector<vector<int> >& W);
-vector<int> getAllPath(vector<int>& path, Graph<int>& g);
-vector<int> calculatePath(vector<int>& pois, vector<vector<int> >& W);
-vector<vector<int> > constructPaths(MapReading& mr, GraphViewer *gv);
+vector<int> calculatePath(const ContractedGraph& g, vector<int>& pois, const vector<int>& sources, const vector<ShortestPaths>& searches);
+vector<ShortestPaths> searchFromPois(const ContractedGraph& g, const vector<int>& pois, vector<int>& sources);
+vector<Route> constructPaths(MapReading& mr, GraphViewer *gv);
 vector<vector<int> > getPathsFromUser(MapReading& mr);
 vector<int> getPathFromUser(int pathId, MapReading& mr);
-vector<Bus> constructBuses(MapReading& mr, vector<vector<int> >& paths);
-void printPath(vector<int>& path);
-void printColorEdges(GraphViewer *gv, map<int, pair<int,int> >& edges, map<int, pair<double,bool> >& edgesProperties, vector<int> allPath, int val);
+int readPoi(const string& s, const SpatialIndex& index);
+vector<Bus> constructBuses(MapReading& mr, vector<Route>& routes);
+void printPath(const vector<int>& path);
+void printColorEdges(GraphViewer *gv, const EdgeIndex& index, EdgeColoring& coloring, const vector<int>& allPath, int val);
 void printColorVertex(GraphViewer *gv, vector<int>& path);
 void addTourists(vector<Bus>& buses);
 void addTourist(vector<Bus>& buses, bool isTheFirstTourist);
@@ -29,32 +38,168 @@ void chooseByPOI(vector<Bus>& buses, Person& tourist);
 void chooseByPersons(vector<Bus>& buses, Person& tourist);
 void printTourists(vector<Bus>& buses);
 void showTheTouristsInBuses(vector<Bus>& buses);
+int runBatch(int argc, char* argv[]);
+int runServer(int argc, char* argv[]);
+void printUsage(const char* program);
+void loadMap(MapReading& mr, const string& path);
+
+int main(int argc, char* argv[]) {
+	if(argc > 1 && strcmp(argv[1], "--serve") == 0)
+		return runServer(argc, argv);
+	if(argc > 1)
+		return runBatch(argc, argv);
 
-int main() {
 	MapReading mr;
 	mr.makeManualGraph();
 
 	GraphViewer *gv = new GraphViewer(900, 600, false);
+	gv->setBatching(true);
+	gv->setAsync(true);
 	gv->createWindow(600, 600);
 	gv->defineEdgeCurved(false);
 	mr.sendDataToGraphViewerManual(gv);
 	gv->rearrange();
 
-	vector<vector<int> > paths = constructPaths(mr, gv);
+	vector<Route> routes = constructPaths(mr, gv);
 
 	mr.sendVertexLabelsToGraphViewer(gv);
 
-	vector<Bus> buses = constructBuses(mr, paths);
+	vector<Bus> buses = constructBuses(mr, routes);
 
 	addTourists(buses);
 
+	delete gv;
+	return 0;
+}
+
+/**
+ * Batch mode: reads a plan (see TourPlan), plans every bus and places every
+ * tourist without any prompt or viewer, and writes the result as JSON to
+ * stdout or to the file given with --out.
+ * Usage: CitySightseeingCal --batch <plan> [--out <file>]
+ */
+int runBatch(int argc, char* argv[]){
+	string planFl, outFl;
+	for(int i = 1;i < argc;i++){
+		if(strcmp(argv[i], "--batch") == 0 && i+1 < argc)
+			planFl = argv[++i];
+		else if(strcmp(argv[i], "--out") == 0 && i+1 < argc)
+			outFl = argv[++i];
+		else{
+			planFl.clear();
+			break;
+		}
+	}
+	if(planFl.empty()){
+		printUsage(argv[0]);
+		return 1;
+	}
+
+	TourPlan plan;
+	MapReading mr;
+	try {
+		plan.readFromFile(planFl);
+		loadMap(mr, plan.getMapPath());
+	}
+	catch(FileNotExists& e){
+		cerr << "Ficheiro nao encontrado: " << e.getNameOfFile() << endl;
+		return 1;
+	}
+	catch(InvalidMapFormat& e){
+		cerr << "Mapa invalido: " << e.getNameOfFile() << " (" << e.getReason() << ")" << endl;
+		return 1;
+	}
+	TourPlanner planner(mr);
+	PlanResult result = planner.execute(plan);
+
+	ofstream file;
+	if(!outFl.empty()){
+		file.open(outFl.c_str());
+		if(!file.is_open()){
+			cerr << "Nao foi possivel escrever " << outFl << endl;
+			return 1;
+		}
+	}
+	JsonWriter w(outFl.empty() ? cout : file);
+	planner.writeResult(w, plan, result);
+	(outFl.empty() ? cout : file) << endl;
+	return 0;
+}
+
+/**
+ * Daemon mode: loads the map once and answers queries (see QueryServer) on a
+ * TCP port of localhost, or on a Unix socket if the address is not a number,
+ * until the process is killed.
+ * Usage: CitySightseeingCal --serve <port|socket> [--map <path>] [--threads <n>]
+ */
+int runServer(int argc, char* argv[]){
+	string address, mapPath;
+	int numThreads = 0;
+	for(int i = 2;i < argc;i++){
+		if(strcmp(argv[i], "--map") == 0 && i+1 < argc)
+			mapPath = argv[++i];
+		else if(strcmp(argv[i], "--threads") == 0 && i+1 < argc)
+			numThreads = atoi(argv[++i]);
+		else if(address.empty() && argv[i][0] != '-')
+			address = argv[i];
+		else{
+			address.clear();
+			break;
+		}
+	}
+	if(address.empty()){
+		printUsage(argv[0]);
+		return 1;
+	}
+
+	MapReading mr;
+	try {
+		loadMap(mr, mapPath);
+	}
+	catch(FileNotExists& e){
+		cerr << "Ficheiro nao encontrado: " << e.getNameOfFile() << endl;
+		return 1;
+	}
+	catch(InvalidMapFormat& e){
+		cerr << "Mapa invalido: " << e.getNameOfFile() << " (" << e.getReason() << ")" << endl;
+		return 1;
+	}
+	TourPlanner planner(mr);
+	QueryServer server(planner, numThreads);
+
+	bool isPort = address.find_first_not_of("0123456789") == string::npos;
+	long port = isPort ? strtol(address.c_str(), NULL, 10) : 0;
+	if(!(isPort ? server.listenTcp(port > 65535 ? 0 : (int) port) : server.listenUnix(address))){
+		cerr << "Nao foi possivel escutar em " << address << endl;
+		return 1;
+	}
+	cerr << "A servir " << planner.getNumNodes() << " nos em " << address << endl;
+	server.run();
 	return 0;
 }
 
+void printUsage(const char* program){
+	cerr << "Uso: " << program << " [--batch <plano> [--out <ficheiro>]]" << endl;
+	cerr << "     " << program << " --serve <porto|socket> [--map <mapa>] [--threads <n>]" << endl;
+}
+
+/**
+ * Manual graph if path is empty, a binary map if it ends in .bin, otherwise
+ * the directory with nodes.txt, roads.txt and edges.txt.
+ */
+void loadMap(MapReading& mr, const string& path){
+	if(path.empty())
+		mr.makeManualGraph();
+	else if(path.size() > 4 && path.compare(path.size() - 4, 4, ".bin") == 0)
+		mr.readBinaryMap(path);
+	else
+		mr.readMap(path + "/nodes.txt", path + "/roads.txt", path + "/edges.txt");
+}
+
 void showTheTouristsInBuses(vector<Bus>& buses){
 	for(size_t i = 0;i < buses.size();i++){
 		cout << "Turistas no autocarro " << i+1 << endl;
-		Bus bus = buses[i];
+		Bus& bus = buses[i];
 		vector<Person> touristsInBus = bus.getTourists();
 		for(size_t j = 0;j < touristsInBus.size();j++){
 			cout << touristsInBus[j].getName() << endl;
@@ -149,7 +294,7 @@ void chooseByPersons(vector<Bus>& buses, Person& tourist){
 		getline(cin, name);
 
 		for(size_t i = 0;i < buses.size();i++){
-			Bus bus = buses[i];
+			Bus& bus = buses[i];
 			vector<Person> touristsInBus = bus.getTourists();
 			for(size_t j = 0;j < touristsInBus.size();j++){
 				if(touristsInBus[j].getName() == name){
@@ -160,7 +305,7 @@ void chooseByPersons(vector<Bus>& buses, Person& tourist){
 		}
 		vector<int> values;
 		for(size_t j = 0 ; j < buses.size(); j++){
-			Bus b = buses[j];
+			Bus& b = buses[j];
 			vector<Person> tourists = b.getTourists();
 			string nome = minName(name, tourists);
 			boolean state = false;
@@ -223,42 +368,58 @@ void printTourists(vector<Bus>& buses){
 	}
 }
 
-vector<Bus> constructBuses(MapReading& mr, vector<vector<int> >& paths){
+vector<Bus> constructBuses(MapReading& mr, vector<Route>& routes){
 	vector<Bus> buses;
-	map<int, string> nameOfNodes = mr.getNameOfNodes();
+	const vector<string>& nameOfNodes = mr.getNameOfNodes();
 
-	for(size_t i = 0;i < paths.size();i++){
-		vector<int> path = paths[i];
-		Bus bus(path);
+	buses.reserve(routes.size());
+	for(size_t i = 0;i < routes.size();i++){
+		Bus bus(std::move(routes[i]));
+		const vector<int>& path = bus.getRoute().getNodes();
 		for(size_t j = 0;j < path.size();j++){
 			string poiName = nameOfNodes[path[j]];
 			bus.addPoi(poiName);
 		}
-		buses.push_back(bus);
+		buses.push_back(std::move(bus));
 	}
 
 	return buses;
 }
 
-vector<vector<int> > constructPaths(MapReading& mr, GraphViewer *gv){
-	Graph<int> g = mr.getGraph();
-	g.floydWarshallShortestPath();
-	vector<vector<int> > W = g.getWeightBetweenAllVertexs();
+/**
+ * Routes on the map contracted around the POIs of every bus, with one Dijkstra
+ * search per POI instead of Floyd-Warshall over the whole map. The same
+ * searches give the distances between the POIs and expand the routes.
+ */
+vector<Route> constructPaths(MapReading& mr, GraphViewer *gv){
 	vector<vector<int> > paths = getPathsFromUser(mr);
+	vector<int> pois;
+	for(size_t i = 0;i < paths.size();i++)
+		pois.insert(pois.end(), paths[i].begin(), paths[i].end());
+	ContractedGraph g(mr.getCompactGraph(), pois);
+	vector<int> sources;
+	vector<ShortestPaths> searches = searchFromPois(g, pois, sources);
+	vector<Route> routes;
+	routes.reserve(paths.size());
+	EdgeIndex index = mr.getEdgeIndex();
+	EdgeColoring coloring(mr.getEdges().size());
 
 	for(size_t i = 0;i < paths.size();i++){
-		vector<int> path = calculatePath(paths[i], W);
+		vector<int> path = calculatePath(g, paths[i], sources, searches);
 
 		cout << "Caminho " << i+1 << endl;
-		vector<int> allPath = getAllPath(path, g);
-		printPath(allPath);
-		printColorEdges(gv, mr.getEdges(), mr.getEdgesProperties(), allPath, i);
+		Route route(path);
+		route.expand(g, sources, searches);
+		if(!route.isComplete())
+			cout << "Nao existe caminho entre alguns dos POIs deste autocarro" << endl;
+		printPath(route.getNodes());
+		printColorEdges(gv, index, coloring, route.getNodes(), i);
 		printColorVertex(gv, path);
 		gv->rearrange();
 
-		paths[i] = allPath;
+		routes.push_back(std::move(route));
 	}
-	return paths;
+	return routes;
 }
 
 vector<vector<int> > getPathsFromUser(MapReading& mr){
@@ -285,12 +446,13 @@ vector<int> getPathFromUser(int pathId, MapReading& mr){
 	vector<int> path;
 	string s;
 	int max = mr.getNodes().size();
+	SpatialIndex index = mr.getSpatialIndex();
 
-	cout << "Indique os Pois do autocarro " << pathId+1 << endl;
+	cout << "Indique os Pois do autocarro " << pathId+1 << " (id ou coordenadas x,y)" << endl;
 	while(1){
 		cout << "Poi de partida: ";
 		getline(cin, s);
-		int val = atoi(s.c_str());
+		int val = readPoi(s, index);
 		if(val > -1 && val < max){
 			path.push_back(val);
 			break;
@@ -302,7 +464,7 @@ vector<int> getPathFromUser(int pathId, MapReading& mr){
 	while(1){
 		cout << "Poi de chegada: ";
 		getline(cin, s);
-		int val = atoi(s.c_str());
+		int val = readPoi(s, index);
 		if(val > -1 && val < max){
 			path.push_back(val);
 			break;
@@ -318,7 +480,7 @@ vector<int> getPathFromUser(int pathId, MapReading& mr){
 		if(s == "-1")
 			break;
 		else{
-			int val = atoi(s.c_str());
+			int val = readPoi(s, index);
 			if(val > -1 && val < max){
 				path.push_back(val);
 
@@ -331,21 +493,20 @@ vector<int> getPathFromUser(int pathId, MapReading& mr){
 	return path;
 }
 
-vector<int> getAllPath(vector<int>& path, Graph<int>& g){
-	vector<int> allPath;
-	for(size_t j = 0;j < path.size()-1;j++){
-		vector<int> subPath = g.getfloydWarshallPath(path[j], path[j+1]);
-		for(size_t k = 0;k < subPath.size();k++){
-			if(j > 0 && k == 0)
-				continue;
-			allPath.push_back(subPath[k]);
-		}
-
+/**
+ * Reads a POI given by its id, or by coordinates "x,y" that are snapped to the nearest node.
+ */
+int readPoi(const string& s, const SpatialIndex& index){
+	double x, y;
+	if(s.find(',') != string::npos && sscanf(s.c_str(), "%lf,%lf", &x, &y) == 2){
+		int val = index.nearest(x, y);
+		cout << "Poi mais proximo: " << val << endl;
+		return val;
 	}
-	return allPath;
+	return atoi(s.c_str());
 }
 
-void printPath(vector<int>& path){
+void printPath(const vector<int>& path){
 	for(size_t i = 0;i < path.size();i++){
 		if(i%30 == 0 && i!= 0)
 			cout << endl;
@@ -354,11 +515,37 @@ void printPath(vector<int>& path){
 	cout << endl;
 }
 
-vector<int> calculatePath(vector<int>& pois, vector<vector<int> >& W){
-	int idStart = pois[0];
-	int idEnd = pois[1];
-	Graph<int> graphWithPois = createGraphUsingPois(pois, W);
-	return graphWithPois.getPathSalesmanProblem(idStart, idEnd);
+/**
+ * Tour over the POIs of one bus, empty if some of them can not be reached.
+ * searches[i] is the search from sources[i], which has every POI.
+ */
+vector<int> calculatePath(const ContractedGraph& g, vector<int>& pois, const vector<int>& sources, const vector<ShortestPaths>& searches){
+	int k = pois.size();
+	vector<int> dist(k*k);
+	for(int i = 0;i < k;i++){
+		const ShortestPaths& sp = searches[find(sources.begin(), sources.end(), pois[i]) - sources.begin()];
+		for(int j = 0;j < k;j++){
+			double d = g.getDistance(sp, pois[j]);
+			dist[i*k + j] = d < 0 ? INT_INFINITY : (int) d;
+		}
+	}
+	DistanceTable table(pois, dist);
+	return table.getPathSalesmanProblem(0, 1);
+}
+
+/**
+ * One search on g from every POI, repeated POIs being searched once.
+ * sources gets the POI of each search.
+ */
+vector<ShortestPaths> searchFromPois(const ContractedGraph& g, const vector<int>& pois, vector<int>& sources){
+	sources.clear();
+	for(size_t i = 0;i < pois.size();i++)
+		if(find(sources.begin(), sources.end(), pois[i]) == sources.end())
+			sources.push_back(pois[i]);
+	vector<ShortestPaths> searches(sources.size());
+	for(size_t i = 0;i < sources.size();i++)
+		g.dijkstraShortestPath(sources[i], searches[i]);
+	return searches;
 }
 
 long int calcDistOfPath(vector<int> path, vector<vector<int> >& W){
@@ -369,24 +556,11 @@ long int calcDistOfPath(vector<int> path, vector<vector<int> >& W){
 	return d;
 }
 
-Graph<int> createGraphUsingPois(vector<int>& poisV, vector<vector<int> >& W){
-	Graph<int> g;
-	for(size_t k = 0;k < poisV.size();k++)
-		g.addVertex(poisV[k]);
-
-	for(size_t k = 0;k < poisV.size();k++)
-		for(size_t w = 0;w < poisV.size();w++){
-			if(k == w)
-				continue;
-			int weight = W[poisV[k]][poisV[w]];
-			if(weight != 0 && weight != INT_INFINITY)
-				g.addEdge(poisV[k],poisV[w],weight);
-
-		}
-	return g;
-}
-
-void printColorEdges(GraphViewer *gv, map<int, pair<int,int> >& edges, map<int, pair<double,bool> >& edgesProperties, vector<int> allPath, int val){
+/**
+ * Colours the edges of the path, both ways on two-way roads, sending only
+ * the edges that do not have the colour yet.
+ */
+void printColorEdges(GraphViewer *gv, const EdgeIndex& index, EdgeColoring& coloring, const vector<int>& allPath, int val){
 
 	vector<string> cores;
 	cores.push_back("RED");
@@ -397,14 +571,7 @@ void printColorEdges(GraphViewer *gv, map<int, pair<int,int> >& edges, map<int,
 	cores.push_back("YELLOW");
 	cores.push_back("PINK");
 
-	for (size_t i = 0; i < allPath.size() - 1; ++i)
-		for(size_t j = 0; j < edges.size(); j++){
-			if(edges[j].first == allPath[i] && edges[j].second == allPath[i + 1])
-				gv->setEdgeColor(j, cores[val%7]);
-			if(edgesProperties[j].second == true)
-				if(edges[j].second == allPath[i] && edges[j].first == allPath[i + 1])
-					gv->setEdgeColor(j, cores[val%7]);
-		}
+	coloring.paint(gv, index.getPathEdges(allPath), cores[val%7]);
 }
 
 void printColorVertex(GraphViewer *gv, vector<int>& path){
@@ -0,0 +1,592 @@
+/*
+ * Benchmark.cpp
+ *
+ * Times the Graph algorithms, the tour solvers and the string algorithms on the
+ * map of the project (nodes.txt, roads.txt, edges.txt read through MapReading) and
+ * on generated grid and random geometric graphs of several sizes, and the
+ * ViewportStreamer on a generated grid map (450x450, 150x150 with --quick).
+ * Results are written as JSON to stdout, or to the file given with --out.
+ *
+ * Build from the repository root, with every .cpp of CitySightseeingCal/src except
+ * main.cpp:
+ *   g++ -std=gnu++11 -O2 -pthread -ICitySightseeingCal/src tools/Benchmark.cpp
+ *       <the .cpp files of CitySightseeingCal/src but main.cpp> -o benchmark
+ *
+ * Usage: benchmark [--map <dir>] [--out <file>] [--min-time <seconds>] [--quick]
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <functional>
+
+#ifdef linux
+#include <sys/resource.h>
+#else
+#include <windows.h>
+#include <psapi.h>
+#endif
+
+#include "Graph.h"
+#include "CompactGraph.h"
+#include "ContractedGraph.h"
+#include "SpatialIndex.h"
+#include "EdgeIndex.h"
+#include "MapReading.h"
+#include "DistanceTable.h"
+#include "StringAlgorithms.h"
+#include "JsonWriter.h"
+#include "GraphRenderer.h"
+#include "graphviewer.h"
+
+struct BenchmarkResult {
+	string name;
+	string graph;
+	int vertices;
+	int edges;
+	long long iterations;
+	double nsPerOp;
+	double opsPerSec;
+	double itemsPerSec;
+};
+
+double minTime = 0.2;
+vector<BenchmarkResult> results;
+//results of the operations that return only a number, so the compiler can not drop the calls
+volatile long long sink;
+
+long peakRssKb(){
+#ifdef linux
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_maxrss;
+#else
+	PROCESS_MEMORY_COUNTERS pmc;
+	GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc));
+	return pmc.PeakWorkingSetSize / 1024;
+#endif
+}
+
+/**
+ * Runs op until minTime has passed (at least once) and records the mean time per call.
+ * items is the amount of work done by one call, used for the throughput.
+ */
+void run(string name, string graph, int vertices, int edges, double items, function<void()> op){
+	typedef chrono::steady_clock Clock;
+	long long iterations = 0;
+	Clock::time_point start = Clock::now();
+	double elapsed = 0;
+	do {
+		op();
+		iterations++;
+		elapsed = chrono::duration<double>(Clock::now() - start).count();
+	} while(elapsed < minTime);
+
+	BenchmarkResult r;
+	r.name = name;
+	r.graph = graph;
+	r.vertices = vertices;
+	r.edges = edges;
+	r.iterations = iterations;
+	r.nsPerOp = elapsed * 1e9 / iterations;
+	r.opsPerSec = iterations / elapsed;
+	r.itemsPerSec = items * iterations / elapsed;
+	results.push_back(r);
+	cerr << name << " " << graph << ": " << r.nsPerOp << " ns/op" << endl;
+}
+
+struct EdgeList {
+	string name;
+	int numVertex;
+	vector<int> origins;
+	vector<int> dests;
+	vector<int> weights;
+};
+
+/**
+ * Graph does not own its vertices, so the benchmark frees them itself to keep the
+ * peak RSS meaningful.
+ */
+void destroyGraph(Graph<int>& g){
+	vector<Vertex<int>*> vs = g.getVertexSet();
+	for(size_t i = 0;i < vs.size();i++)
+		delete vs[i];
+}
+
+Graph<int> buildGraph(const EdgeList& el){
+	Graph<int> g;
+	for(int i = 0;i < el.numVertex;i++)
+		g.addVertex(i);
+	for(size_t i = 0;i < el.origins.size();i++)
+		g.addEdge(el.origins[i], el.dests[i], el.weights[i], i);
+	return g;
+}
+
+/**
+ * Square grid with two-way streets between neighbouring crossings.
+ */
+EdgeList makeGrid(int side){
+	EdgeList el;
+	stringstream ss;
+	ss << "grid" << side << "x" << side;
+	el.name = ss.str();
+	el.numVertex = side*side;
+	for(int r = 0;r < side;r++)
+		for(int c = 0;c < side;c++){
+			int v = r*side + c;
+			int w = 80 + rand()%40;
+			if(c+1 < side){
+				el.origins.push_back(v); el.dests.push_back(v+1); el.weights.push_back(w);
+				el.origins.push_back(v+1); el.dests.push_back(v); el.weights.push_back(w);
+			}
+			if(r+1 < side){
+				el.origins.push_back(v); el.dests.push_back(v+side); el.weights.push_back(w);
+				el.origins.push_back(v+side); el.dests.push_back(v); el.weights.push_back(w);
+			}
+		}
+	return el;
+}
+
+/**
+ * Random geometric graph: n points in a 1000x1000 square, linked when closer than
+ * a radius chosen for an average degree of about 6.
+ */
+EdgeList makeRandomGeometric(int n){
+	EdgeList el;
+	stringstream ss;
+	ss << "rgg" << n;
+	el.name = ss.str();
+	el.numVertex = n;
+	vector<double> x(n), y(n);
+	for(int i = 0;i < n;i++){
+		x[i] = rand() % 1000000 / 1000.0;
+		y[i] = rand() % 1000000 / 1000.0;
+	}
+	double radius = 1000.0 * sqrt(6.0 / (3.14159265 * n));
+	for(int i = 0;i < n;i++)
+		for(int j = i+1;j < n;j++){
+			double d = sqrt((x[i]-x[j])*(x[i]-x[j]) + (y[i]-y[j])*(y[i]-y[j]));
+			if(d < radius){
+				el.origins.push_back(i); el.dests.push_back(j); el.weights.push_back(d + 1);
+				el.origins.push_back(j); el.dests.push_back(i); el.weights.push_back(d + 1);
+			}
+		}
+	return el;
+}
+
+EdgeList fromMap(MapReading& mr){
+	EdgeList el;
+	el.name = "map";
+	el.numVertex = mr.getNodes().size();
+	vector<pair<int,int> >& edges = mr.getEdges();
+	vector<pair<double,bool> >& props = mr.getEdgesProperties();
+	for(size_t i = 0;i < edges.size();i++){
+		el.origins.push_back(edges[i].first);
+		el.dests.push_back(edges[i].second);
+		el.weights.push_back(props[i].first);
+		if(props[i].second){
+			el.origins.push_back(edges[i].second);
+			el.dests.push_back(edges[i].first);
+			el.weights.push_back(props[i].first);
+		}
+	}
+	return el;
+}
+
+/**
+ * Nearest neighbour tours over k POIs spread over the graph. Graph::getPathSalesmanProblem
+ * cannot handle POIs that do not reach each other, so it is only timed when they all do.
+ */
+void benchTours(const EdgeList& el, const vector<vector<int> >& W){
+	int V = el.numVertex;
+	int E = el.origins.size();
+	int sizes[] = {10, 50};
+	for(int s = 0;s < 2;s++){
+		int k = min(sizes[s], V);
+		vector<int> pois;
+		for(int i = 0;i < k;i++)
+			pois.push_back((long long)i * V / k);
+		stringstream ss;
+		ss << "tour" << k;
+
+		run(ss.str() + "_distanceTable", el.name, V, E, k*k, [&](){
+			vector<int> dist(k*k);
+			for(int i = 0;i < k;i++)
+				for(int j = 0;j < k;j++)
+					dist[i*k + j] = W[pois[i]][pois[j]];
+			DistanceTable table(pois, dist);
+			vector<int> tour = table.getPathSalesmanProblem(0, 1);
+			sink = sink + tour.size();
+		});
+
+		bool complete = true;
+		for(int i = 0;i < k;i++)
+			for(int j = 0;j < k;j++)
+				if(i != j && (W[pois[i]][pois[j]] == 0 || W[pois[i]][pois[j]] == INT_INFINITY))
+					complete = false;
+		if(!complete)
+			continue;
+		run(ss.str() + "_graphSalesman", el.name, V, E, k*k, [&](){
+			Graph<int> poiGraph;
+			for(int i = 0;i < k;i++)
+				poiGraph.addVertex(pois[i]);
+			for(int i = 0;i < k;i++)
+				for(int j = 0;j < k;j++)
+					if(i != j)
+						poiGraph.addEdge(pois[i], pois[j], W[pois[i]][pois[j]]);
+			vector<int> tour = poiGraph.getPathSalesmanProblem(pois[0], pois[1]);
+			destroyGraph(poiGraph);
+		});
+	}
+}
+
+void benchGraph(const EdgeList& el, int maxFloydVertex){
+	int V = el.numVertex;
+	int E = el.origins.size();
+
+	run("build", el.name, V, E, V + E, [&](){
+		Graph<int> g = buildGraph(el);
+		destroyGraph(g);
+	});
+
+	vector<pair<int,int> > edges(E);
+	vector<pair<double,bool> > properties(E);
+	for(int i = 0;i < E;i++){
+		edges[i] = pair<int,int>(el.origins[i], el.dests[i]);
+		properties[i] = pair<double,bool>(el.weights[i], false);
+	}
+	run("buildCompactGraph", el.name, V, E, V + E, [&](){
+		CompactGraph cg(V, edges, properties);
+	});
+	CompactGraph cg(V, edges, properties);
+	ShortestPaths sp;
+	int compactSource = 0;
+	run("compactDijkstraShortestPath", el.name, V, E, E, [&](){
+		cg.dijkstraShortestPath(compactSource, sp);
+		compactSource = (compactSource + 7) % V;
+	});
+
+	Graph<int> g = buildGraph(el);
+	int source = 0;
+	run("dijkstraShortestPath", el.name, V, E, E, [&](){
+		g.dijkstraShortestPath(source);
+		source = (source + 7) % V;
+	});
+	run("bellmanFordShortestPath", el.name, V, E, E, [&](){
+		g.bellmanFordShortestPath(source);
+		source = (source + 7) % V;
+	});
+	//rush hours on two edges out of three, so the search really interpolates
+	stringstream profileText;
+	for(int i = 0;i < E;i++)
+		if(i % 3 == 0)
+			profileText << i << ";0,1;25200,1.8;34200,1.2;61200,2.0\n";
+		else if(i % 3 == 1)
+			profileText << i << ";0,1;28800,1.5;64800,1.5\n";
+	TravelTimeProfiles profiles;
+	profiles.readFromFile(profileText);
+	profiles.setNumEdges(E);
+	run("timeDependentShortestPath", el.name, V, E, E, [&](){
+		g.timeDependentShortestPath(source, 30000, profiles);
+		source = (source + 7) % V;
+	});
+	run("getKShortestPaths", el.name, V, E, E, [&](){
+		vector<int> costs;
+		g.getKShortestPaths(source, (source + V/2) % V, 5, costs);
+		source = (source + 7) % V;
+	});
+	run("getStrongestConnectedComponents", el.name, V, E, V + E, [&](){
+		vector<set<int> > scc = g.getStrongestConnectedComponents();
+	});
+	run("findArt", el.name, V, E, V + E, [&](){
+		vector<int> art;
+		g.findArt(0, art);
+	});
+
+	if(V <= maxFloydVertex){
+		run("floydWarshallShortestPath", el.name, V, E, (double)V*V*V, [&](){
+			g.floydWarshallShortestPath();
+		});
+		benchTours(el, g.getWeightBetweenAllVertexs());
+	}
+	destroyGraph(g);
+}
+
+/**
+ * Viewer backend that only counts the commands, so that the viewport
+ * benchmarks time the streamer and not the drawing.
+ */
+class CountingRenderer: public GraphRenderer {
+
+private:
+	bool count(){
+		commands++;
+		return true;
+	}
+
+public:
+	long long commands;
+
+	CountingRenderer(): commands(0) {}
+
+	bool createWindow(int, int){ return count(); }
+	bool closeWindow(){ return count(); }
+	bool addNode(int, int, int){ return count(); }
+	bool addNode(int){ return count(); }
+	bool addEdge(int, int, int, int){ return count(); }
+	bool removeNode(int){ return count(); }
+	bool removeEdge(int){ return count(); }
+	bool setVertexLabel(int, string){ return count(); }
+	bool setEdgeLabel(int, string){ return count(); }
+	bool setEdgeColor(int, string){ return count(); }
+	bool setEdgeDashed(int, bool){ return count(); }
+	bool setVertexColor(int, string){ return count(); }
+	bool setVertexSize(int, int){ return count(); }
+	bool setVertexIcon(int, string){ return count(); }
+	bool setEdgeThickness(int, int){ return count(); }
+	bool setEdgeWeight(int, int){ return count(); }
+	bool setEdgeFlow(int, int){ return count(); }
+	bool defineEdgeCurved(bool){ return count(); }
+	bool defineEdgeColor(string){ return count(); }
+	bool defineEdgeDashed(bool){ return count(); }
+	bool defineVertexColor(string){ return count(); }
+	bool defineVertexSize(int){ return count(); }
+	bool defineVertexIcon(string){ return count(); }
+	bool setBackground(string){ return count(); }
+	bool rearrange(){ return count(); }
+};
+
+/**
+ * Map of side x side crossings about 11 m apart, read through the text
+ * parsers. Every row and every column is a road, one-way on odd rows.
+ */
+void makeGridMap(int side, MapReading& mr){
+	const double degToRad = 3.14159265358979323846 / 180;
+	stringstream nodes, roads, edges;
+	nodes.precision(12);
+	for(int i = 0;i < side;i++)
+		for(int j = 0;j < side;j++){
+			double lat = 41.1 + i*1e-4, lon = -8.6 + j*1e-4;
+			nodes << (long long) i*side + j << ";" << lat << ";" << lon << ";" << lon*degToRad << ";" << lat*degToRad << "\n";
+		}
+	for(int i = 0;i < 2*side;i++)
+		roads << i << ";Rua " << i << ";" << (i < side && i % 2 ? "False" : "True") << "\n";
+	for(int i = 0;i < side;i++)
+		for(int j = 0;j < side;j++){
+			long long v = (long long) i*side + j;
+			if(j + 1 < side)
+				edges << i << ";" << v << ";" << v + 1 << ";\n";
+			if(i + 1 < side)
+				edges << side + j << ";" << v << ";" << v + side << ";\n";
+		}
+	string r = roads.str(), n = nodes.str(), e = edges.str();
+	mr.readRoadsFromBuffer(r.data(), r.data() + r.size());
+	mr.readNodesFromBuffer(n.data(), n.data() + n.size());
+	mr.readEdgesFromBuffer(e.data(), e.data() + e.size());
+}
+
+/**
+ * Builds the streamer, pans a detailed viewport of about 500 nodes across the
+ * map in steps of 1% of its width, and switches between the whole map (the
+ * skeleton) and a detailed viewport. items is the number of viewer commands.
+ */
+void benchViewport(int side){
+	MapReading mr;
+	makeGridMap(side, mr);
+	stringstream ss;
+	ss << "gridmap" << side << "x" << side;
+	int V = mr.getNodes().size(), E = mr.getEdges().size();
+	run("getViewportStreamer", ss.str(), V, E, V + E, [&](){
+		ViewportStreamer vs = mr.getViewportStreamer(900, 600);
+	});
+
+	double minX = mr.getNodes()[0].first, minY = mr.getNodes()[0].second, maxX = minX, maxY = minY;
+	for(int i = 0;i < V;i++){
+		minX = min(minX, mr.getNodes()[i].first);
+		minY = min(minY, mr.getNodes()[i].second);
+		maxX = max(maxX, mr.getNodes()[i].first);
+		maxY = max(maxY, mr.getNodes()[i].second);
+	}
+	double width = maxX - minX, height = maxY - minY;
+	double window = 22.0 / side;			//about 22x22 nodes
+	CountingRenderer* renderer = new CountingRenderer();
+	GraphViewer gv(900, 600, false, renderer);
+
+	ViewportStreamer vs = mr.getViewportStreamer(900, 600);
+	int step = 0;
+	long long before = renderer->commands;
+	run("viewportPan", ss.str(), V, E, 0, [&](){
+		double x = minX + width * ((step % 90) / 100.0);
+		double y = minY + height * 0.5;
+		vs.setViewport(&gv, x, y, x + width*window, y + height*window);
+		step++;
+	});
+	results.back().itemsPerSec = (renderer->commands - before) / (results.back().nsPerOp * results.back().iterations / 1e9);
+
+	step = 0;
+	before = renderer->commands;
+	run("viewportZoom", ss.str(), V, E, 0, [&](){
+		if(step % 2 == 0)
+			vs.setViewport(&gv, minX, minY, maxX, maxY);
+		else
+			vs.setViewport(&gv, minX + width*0.5, minY + height*0.5, minX + width*(0.5 + window), minY + height*(0.5 + window));
+		step++;
+	});
+	results.back().itemsPerSec = (renderer->commands - before) / (results.back().nsPerOp * results.back().iterations / 1e9);
+}
+
+string randomText(int size, int alphabet){
+	string s(size, 'a');
+	for(int i = 0;i < size;i++)
+		s[i] = 'a' + rand() % alphabet;
+	return s;
+}
+
+void benchStrings(){
+	int textSizes[] = {1000, 100000};
+	for(int i = 0;i < 2;i++){
+		string t = randomText(textSizes[i], 4);
+		string p = randomText(8, 4);
+		stringstream ss;
+		ss << "text" << textSizes[i];
+		run("kmp_matcher", ss.str(), 0, 0, textSizes[i], [&](){
+			sink = sink + kmp_matcher(t, p);
+		});
+	}
+	int nameSizes[] = {16, 256};
+	for(int i = 0;i < 2;i++){
+		string a = randomText(nameSizes[i], 26);
+		string b = randomText(nameSizes[i], 26);
+		stringstream ss;
+		ss << "names" << nameSizes[i];
+		run("editDistance", ss.str(), 0, 0, (double)nameSizes[i]*nameSizes[i], [&](){
+			sink = sink + editDistance(a, b);
+		});
+	}
+}
+
+void writeResults(ostream& os){
+	JsonWriter w(os);
+	w.beginObject();
+	w.key("min_time_s");
+	w.value(minTime);
+	w.key("benchmarks");
+	w.beginArray();
+	for(size_t i = 0;i < results.size();i++){
+		const BenchmarkResult& r = results[i];
+		w.beginObject();
+		w.key("name"); w.value(r.name);
+		w.key("input"); w.value(r.graph);
+		w.key("vertices"); w.value(r.vertices);
+		w.key("edges"); w.value(r.edges);
+		w.key("iterations"); w.value(r.iterations);
+		w.key("ns_per_op"); w.value(r.nsPerOp);
+		w.key("ops_per_s"); w.value(r.opsPerSec);
+		w.key("items_per_s"); w.value(r.itemsPerSec);
+		w.endObject();
+	}
+	w.endArray();
+	w.key("peak_rss_kb");
+	w.value((long long)peakRssKb());
+	w.endObject();
+	os << endl;
+}
+
+int main(int argc, char* argv[]){
+	string mapDir = "CitySightseeingCal";
+	string outFile;
+	bool quick = false;
+	for(int i = 1;i < argc;i++){
+		if(strcmp(argv[i], "--map") == 0 && i+1 < argc)
+			mapDir = argv[++i];
+		else if(strcmp(argv[i], "--out") == 0 && i+1 < argc)
+			outFile = argv[++i];
+		else if(strcmp(argv[i], "--min-time") == 0 && i+1 < argc)
+			minTime = atof(argv[++i]);
+		else if(strcmp(argv[i], "--quick") == 0)
+			quick = true;
+		else{
+			cerr << "Usage: " << argv[0] << " [--map <dir>] [--out <file>] [--min-time <seconds>] [--quick]" << endl;
+			return 1;
+		}
+	}
+	srand(42);
+
+	MapReading mr;
+	run("readMap", "map", 0, 0, 1, [&](){
+		MapReading m;
+		m.readMap(mapDir + "/nodes.txt", mapDir + "/roads.txt", mapDir + "/edges.txt");
+	});
+	mr.readMap(mapDir + "/nodes.txt", mapDir + "/roads.txt", mapDir + "/edges.txt");
+	string binaryFl = "benchmark_map.bin";
+	mr.writeBinaryMap(binaryFl);
+	run("readBinaryMap", "map", mr.getNodes().size(), mr.getEdges().size(), 1, [&](){
+		MapReading m;
+		m.readBinaryMap(binaryFl);
+	});
+	remove(binaryFl.c_str());
+	run("getGraph", "map", mr.getNodes().size(), mr.getEdges().size(), 1, [&](){
+		Graph<int> g = mr.getGraph();
+		destroyGraph(g);
+	});
+	run("getCompactGraph", "map", mr.getNodes().size(), mr.getEdges().size(), 1, [&](){
+		CompactGraph g = mr.getCompactGraph();
+	});
+	CompactGraph compact = mr.getCompactGraph();
+	run("contractGraph", "map", compact.getNumVertex(), compact.getNumArcs(), compact.getNumVertex() + compact.getNumArcs(), [&](){
+		ContractedGraph cg(compact);
+	});
+	ContractedGraph contracted(compact);
+	ShortestPaths sp;
+	int contractedSource = 0;
+	run("contractedDijkstraShortestPath", "map", contracted.getNumVertex(), contracted.getGraph().getNumArcs(), contracted.getGraph().getNumArcs(), [&](){
+		contracted.getGraph().dijkstraShortestPath(contractedSource, sp);
+		contractedSource = (contractedSource + 7) % contracted.getNumVertex();
+	});
+	run("getSpatialIndex", "map", mr.getNodes().size(), 0, mr.getNodes().size(), [&](){
+		SpatialIndex index = mr.getSpatialIndex();
+	});
+	SpatialIndex index = mr.getSpatialIndex();
+	vector<pair<double,double> > locations;
+	for(size_t i = 0;i < 10000;i++){
+		const pair<double,double>& p = mr.getNodes()[rand() % mr.getNodes().size()];
+		locations.push_back(pair<double,double>(p.first + rand() % 200 - 100, p.second + rand() % 200 - 100));
+	}
+	run("snap", "map", mr.getNodes().size(), 0, locations.size(), [&](){
+		vector<int> snapped = index.snap(locations);
+	});
+	run("getEdgeIndex", "map", mr.getNodes().size(), mr.getEdges().size(), mr.getEdges().size(), [&](){
+		EdgeIndex edgeIndex = mr.getEdgeIndex();
+	});
+	EdgeIndex edgeIndex = mr.getEdgeIndex();
+	vector<int> walk;
+	for(size_t i = 0;i < 10000;i++){
+		const pair<int,int>& e = mr.getEdges()[rand() % mr.getEdges().size()];
+		walk.push_back(e.first);
+		walk.push_back(e.second);
+	}
+	run("getPathEdges", "map", mr.getNodes().size(), mr.getEdges().size(), walk.size(), [&](){
+		vector<int> pathEdges = edgeIndex.getPathEdges(walk);
+	});
+	benchGraph(fromMap(mr), 1000);
+
+	int gridSides[] = {10, 20, 40};
+	int rggSizes[] = {100, 400, 1600};
+	int numSizes = quick ? 2 : 3;
+	for(int i = 0;i < numSizes;i++){
+		benchGraph(makeGrid(gridSides[i]), 400);
+		benchGraph(makeRandomGeometric(rggSizes[i]), 400);
+	}
+	benchViewport(quick ? 150 : 450);
+	benchStrings();
+
+	if(outFile.empty())
+		writeResults(cout);
+	else{
+		ofstream ofs(outFile.c_str());
+		writeResults(ofs);
+	}
+	return 0;
+}
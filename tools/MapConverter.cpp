@@ -0,0 +1,49 @@
+/*
+ * MapConverter.cpp
+ *
+ * Converts the text map files (nodes.txt, roads.txt, edges.txt) into the binary
+ * map format of BinaryMapFormat.h, which MapReading::readBinaryMap loads without
+ * parsing or projecting anything. The result is read back to check it.
+ *
+ * Build from the repository root, with every .cpp of CitySightseeingCal/src except
+ * main.cpp:
+ *   g++ -std=gnu++11 -O2 -pthread -ICitySightseeingCal/src tools/MapConverter.cpp
+ *       <the .cpp files of CitySightseeingCal/src but main.cpp> -o mapconverter
+ *
+ * Usage: mapconverter <nodes.txt> <roads.txt> <edges.txt> <map.bin>
+ */
+
+#include <iostream>
+#include "MapReading.h"
+#include "InvalidMapFormat.h"
+
+int main(int argc, char* argv[]){
+	if(argc != 5){
+		cerr << "Usage: " << argv[0] << " <nodes.txt> <roads.txt> <edges.txt> <map.bin>" << endl;
+		return 1;
+	}
+
+	try {
+		MapReading text;
+		text.readMap(argv[1], argv[2], argv[3]);
+		text.writeBinaryMap(argv[4]);
+
+		MapReading binary;
+		binary.readBinaryMap(argv[4]);
+		if(binary.getNodes().size() != text.getNodes().size() || binary.getEdges().size() != text.getEdges().size()){
+			cerr << "The binary map does not match the text map" << endl;
+			return 1;
+		}
+		cout << argv[4] << ": " << binary.getNodes().size() << " nodes, "
+				<< binary.getEdges().size() << " edges" << endl;
+	}
+	catch(FileNotExists& e){
+		cerr << "Cannot open " << e.getNameOfFile() << endl;
+		return 1;
+	}
+	catch(InvalidMapFormat& e){
+		cerr << e.getNameOfFile() << ": " << e.getReason() << endl;
+		return 1;
+	}
+	return 0;
+}
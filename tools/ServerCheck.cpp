@@ -0,0 +1,80 @@
+/*
+ * ServerCheck.cpp
+ *
+ * Sends a fixed set of requests to QueryServer::handle on a small map built in
+ * memory and checks the replies: paths, tours and plans over stops that can
+ * and can not be reached, contracted stops, invalid POIs and malformed
+ * requests. Prints one line per request and exits with 1 if any reply is wrong.
+ *
+ *   0 <-> 1 <-> 2 <-> 3 -> 4      5 (no edges)
+ *
+ * Build from the repository root, with every .cpp of CitySightseeingCal/src except
+ * main.cpp:
+ *   g++ -std=gnu++11 -O2 -pthread -ICitySightseeingCal/src tools/ServerCheck.cpp
+ *       <the .cpp files of CitySightseeingCal/src but main.cpp> -o servercheck
+ *
+ * Usage: servercheck
+ */
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include "MapReading.h"
+#include "TourPlanner.h"
+#include "QueryServer.h"
+
+struct Check {
+	const char* request;
+	const char* expected;		//must be part of the reply
+};
+
+void makeLineMap(MapReading& mr){
+	string roads = "0;Rua A;True\n1;Rua B;False\n";
+	string nodes;
+	for(int i = 0;i < 6;i++){
+		double lat = 41.1 + i*1e-3, lon = -8.6;
+		ostringstream os;
+		os.precision(12);
+		os << i << ";" << lat << ";" << lon << ";" << lon*3.14159265358979323846/180 << ";" << lat*3.14159265358979323846/180 << "\n";
+		nodes += os.str();
+	}
+	string edges = "0;0;1;\n0;1;2;\n0;2;3;\n1;3;4;\n";
+	mr.readRoadsFromBuffer(roads.data(), roads.data() + roads.size());
+	mr.readNodesFromBuffer(nodes.data(), nodes.data() + nodes.size());
+	mr.readEdgesFromBuffer(edges.data(), edges.data() + edges.size());
+}
+
+int main(){
+	MapReading mr;
+	makeLineMap(mr);
+	TourPlanner planner(mr);
+	QueryServer server(planner, 1);
+
+	Check checks[] = {
+		{ "{\"id\":1,\"op\":\"ping\"}", "{\"id\":1,\"ok\":true}" },
+		{ "{\"id\":2,\"op\":\"path\",\"from\":0,\"to\":4}", "\"path\":[0,1,2,3,4]" },
+		{ "{\"id\":3,\"op\":\"path\",\"from\":4,\"to\":0}", "\"error\":\"no path\"" },
+		{ "{\"id\":4,\"op\":\"path\",\"from\":1,\"to\":2}", "\"path\":[1,2]" },
+		{ "{\"id\":5,\"op\":\"tour\",\"pois\":[0,4,2]}", "\"stops\":[0,2,4],\"path\":[0,1,2,3,4]" },
+		{ "{\"id\":6,\"op\":\"tour\",\"pois\":[0,3,5]}", "\"error\":\"no path\"" },
+		{ "{\"id\":7,\"op\":\"tour\",\"pois\":[0,4,5,2]}", "\"error\":\"no path\"" },
+		{ "{\"id\":8,\"op\":\"tour\",\"pois\":[4,0]}", "\"error\":\"no path\"" },
+		{ "{\"id\":9,\"op\":\"plan\",\"buses\":[[0,3,1],[0,4,5]]}", "\"error\":\"no path for bus 2\"" },
+		{ "{\"id\":10,\"op\":\"plan\",\"buses\":[[0,\"Rua Z\"]]}", "\"error\":\"invalid POI in bus 1\"" },
+		{ "{\"id\":11,\"op\":\"plan\",\"buses\":[[2,0,3]]}", "\"stops\":[2,3,0],\"path\":[2,3,2,1,0],\"reachable\":true" },
+		{ "{\"id\":12,\"op\":\"tour\",\"pois\":[0]}", "\"ok\":false" },
+		{ "{\"id\":13,\"op\":\"fly\"}", "\"error\":\"unknown op fly\"" },
+		{ "[1,2]", "{\"ok\":false,\"error\":\"invalid JSON object\"}" },
+	};
+
+	int failed = 0;
+	for(size_t i = 0;i < sizeof(checks) / sizeof(checks[0]);i++){
+		string reply = server.handle(checks[i].request);
+		bool ok = reply.find(checks[i].expected) != string::npos;
+		if(!ok)
+			failed++;
+		cout << (ok ? "ok   " : "FAIL ") << checks[i].request << " -> " << reply << endl;
+	}
+	cout << failed << " failed" << endl;
+	return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,126 @@
+/*
+ * ViewerBenchmark.cpp
+ *
+ * Measures how many viewer commands per second GraphViewer gets through the
+ * socket path (SocketRenderer and Connection) in each client mode: synchronous,
+ * batched, batched fire-and-forget, and batched on the asynchronous render
+ * thread. The commands go to an in-process ViewerStub instead of the Java
+ * viewer, so the numbers only include the protocol and the client.
+ * Results, with the stub's counts and latency histograms, are written as JSON
+ * to stdout, or to the file given with --out.
+ *
+ * Build from the repository root, with every .cpp of CitySightseeingCal/src except
+ * main.cpp:
+ *   g++ -std=gnu++11 -O2 -pthread -ICitySightseeingCal/src tools/ViewerBenchmark.cpp
+ *       <the .cpp files of CitySightseeingCal/src but main.cpp> -o viewerbenchmark
+ *
+ * Usage: viewerbenchmark [--port <port>] [--commands <n>] [--delay-us <microseconds>] [--out <file>]
+ */
+
+#include <cstdlib>
+#include <fstream>
+#include "graphviewer.h"
+#include "SocketRenderer.h"
+#include "ViewerStub.h"
+
+struct Mode {
+	const char* name;
+	bool batching;
+	bool fireAndForget;
+	bool async;
+};
+
+/**
+ * Sends n commands (n >= 6): a third adds nodes, a third adds edges between
+ * consecutive nodes and the rest colours those edges.
+ */
+void sendCommands(GraphViewer *gv, int n){
+	static const char* colors[] = { BLUE, RED, GREEN, YELLOW };
+	int numNodes = n / 3 + 1;
+	int numEdges = numNodes - 1;
+	for(int i = 0;i < numNodes;i++)
+		gv->addNode(i, i % 600, i / 600 % 600);
+	for(int i = 0;i < numEdges;i++)
+		gv->addEdge(i, i, i + 1, EdgeType::UNDIRECTED);
+	for(int i = 0;i < n - numNodes - numEdges;i++)
+		gv->setEdgeColor(i % numEdges, colors[i % 4]);
+}
+
+int main(int argc, char* argv[]){
+	int port = 7790;
+	int commands = 50000;
+	int delayUs = 0;
+	string outFile;
+	for(int i = 1;i < argc;i++){
+		if(strcmp(argv[i], "--port") == 0 && i+1 < argc)
+			port = atoi(argv[++i]);
+		else if(strcmp(argv[i], "--commands") == 0 && i+1 < argc)
+			commands = max(6, atoi(argv[++i]));
+		else if(strcmp(argv[i], "--delay-us") == 0 && i+1 < argc)
+			delayUs = atoi(argv[++i]);
+		else if(strcmp(argv[i], "--out") == 0 && i+1 < argc)
+			outFile = argv[++i];
+		else{
+			cerr << "Usage: " << argv[0] << " [--port <port>] [--commands <n>] [--delay-us <microseconds>] [--out <file>]" << endl;
+			return 1;
+		}
+	}
+
+	ViewerStub stub(port, delayUs);
+	if(!stub.start()){
+		cerr << "Cannot listen on port " << port << endl;
+		return 1;
+	}
+
+	ofstream file;
+	if(!outFile.empty())
+		file.open(outFile.c_str());
+	ostream& os = outFile.empty() ? cout : file;
+	JsonWriter w(os);
+	w.beginObject();
+	w.key("commands"); w.value(commands);
+	w.key("delay_us"); w.value(delayUs);
+	w.key("modes");
+	w.beginArray();
+
+	Mode modes[] = {
+		{ "sync", false, false, false },
+		{ "batched", true, false, false },
+		{ "fire_and_forget", true, true, false },
+		{ "async_batched", true, false, true }
+	};
+	long long finished = 0;
+	for(size_t m = 0;m < sizeof(modes)/sizeof(modes[0]);m++){
+		const Mode& mode = modes[m];
+		GraphViewer *gv = new GraphViewer(600, 600, false, new SocketRenderer(600, 600, false, port, false));
+		gv->setBatching(mode.batching, mode.fireAndForget);
+		if(mode.async)
+			gv->setAsync(true);
+
+		typedef chrono::steady_clock Clock;
+		Clock::time_point start = Clock::now();
+		sendCommands(gv, commands);
+		if(mode.fireAndForget)
+			gv->setBatching(true);		//so that the flush waits for the replies
+		bool ok = gv->flush();
+		delete gv;			//waits for the render thread and the last replies
+		double seconds = chrono::duration<double>(Clock::now() - start).count();
+		finished = stub.waitFinished(finished);
+
+		w.beginObject();
+		w.key("name"); w.value(mode.name);
+		w.key("ok"); w.value(ok);
+		w.key("seconds"); w.value(seconds);
+		w.key("commands_per_s"); w.value(commands / seconds);
+		w.key("server");
+		stub.writeStats(w);
+		w.endObject();
+		stub.resetStats();
+		cerr << mode.name << ": " << commands / seconds << " commands/s" << endl;
+	}
+
+	w.endArray();
+	w.endObject();
+	os << endl;
+	return 0;
+}
@@ -0,0 +1,63 @@
+/*
+ * ViewerStub.cpp
+ *
+ * Local stand-in for GraphViewerController.jar (see ViewerStub.h): accepts the
+ * viewer commands on a TCP port, replies "ok" to each and, after every client
+ * disconnects, writes the message counts and latency histograms as JSON to
+ * stdout, or to the file given with --out. Start it before the program and
+ * create the GraphViewer with a SocketRenderer that does not launch the
+ * controller, or let the program launch this stub in place of the jar.
+ *
+ * Build from the repository root:
+ *   g++ -std=gnu++11 -O2 -pthread -ICitySightseeingCal/src tools/ViewerStub.cpp -o viewerstub
+ *
+ * Usage: viewerstub [--port <port>] [--delay-us <microseconds>] [--out <file>] [--once]
+ */
+
+#include <cstdlib>
+#include <fstream>
+#include "ViewerStub.h"
+
+int main(int argc, char* argv[]){
+	int port = 7772;
+	int delayUs = 0;
+	string outFile;
+	bool once = false;
+	for(int i = 1;i < argc;i++){
+		if(strcmp(argv[i], "--port") == 0 && i+1 < argc)
+			port = atoi(argv[++i]);
+		else if(strcmp(argv[i], "--delay-us") == 0 && i+1 < argc)
+			delayUs = atoi(argv[++i]);
+		else if(strcmp(argv[i], "--out") == 0 && i+1 < argc)
+			outFile = argv[++i];
+		else if(strcmp(argv[i], "--once") == 0)
+			once = true;
+		else{
+			cerr << "Usage: " << argv[0] << " [--port <port>] [--delay-us <microseconds>] [--out <file>] [--once]" << endl;
+			return 1;
+		}
+	}
+
+	ViewerStub stub(port, delayUs);
+	if(!stub.start()){
+		cerr << "Cannot listen on port " << port << endl;
+		return 1;
+	}
+	cerr << "Listening on port " << port << endl;
+
+	long long served = 0;
+	while(true){
+		served = stub.waitFinished(served);
+		ofstream file;
+		if(!outFile.empty())
+			file.open(outFile.c_str());
+		ostream& os = outFile.empty() ? cout : file;
+		JsonWriter w(os);
+		stub.writeStats(w);
+		os << endl;
+		stub.resetStats();
+		if(once)
+			break;
+	}
+	return 0;
+}
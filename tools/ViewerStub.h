@@ -0,0 +1,307 @@
+/*
+ * ViewerStub.h
+ *
+ * Stand-in for GraphViewerController.jar, used by ViewerStub.cpp and
+ * ViewerBenchmark.cpp to exercise Connection and SocketRenderer without the
+ * Java GUI.
+ */
+
+#ifndef TOOLS_VIEWERSTUB_H_
+#define TOOLS_VIEWERSTUB_H_
+
+#ifdef linux
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#else
+#include <winsock2.h>
+#endif
+
+#include <cstring>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <condition_variable>
+#include <string>
+#include <thread>
+#include <vector>
+#include "JsonWriter.h"
+
+using namespace std;
+
+/**
+ * Listens on a local TCP port and speaks the line protocol of the viewer:
+ * every command line gets the reply "ok", or "error" if the command is not
+ * one the viewer knows. Nothing is drawn. The commands of every read are
+ * answered with a single write, as a fast viewer would.
+ *
+ * For every command name it counts the messages and keeps a histogram of the
+ * latency from the read that brought the line to the write of its reply:
+ * bucket k holds the latencies in [2^(k-1), 2^k) microseconds, bucket 0 the
+ * ones under a microsecond. delayUs simulates the drawing time of each command.
+ *
+ * Clients are served one at a time on a background thread.
+ */
+class ViewerStub {
+
+public:
+	static const int NUM_BUCKETS = 24;
+	static const size_t READ_BUFFER_SIZE = 1 << 16;
+
+	struct CommandStats {
+		long long count;
+		vector<long long> histogram;
+		CommandStats(): count(0), histogram(NUM_BUCKETS, 0) {}
+	};
+
+private:
+#ifdef linux
+	typedef int Socket;
+#else
+	typedef SOCKET Socket;
+#endif
+
+	short port;
+	int delayUs;
+	Socket listenSock;
+	Socket clientSock;
+	bool clientOpen;
+	thread server;
+	mutex statsMutex;
+	condition_variable clientDone;
+	map<string, CommandStats> stats;
+	long long connections;
+	long long finished;
+	long long bytes;
+
+	static bool isCommand(const string& name){
+		static const char* names[] = {
+			"newGraph", "createWindow", "closeWindow", "addNode1", "addNode3", "addEdge",
+			"removeNode", "removeEdge", "setVertexLabel", "setEdgeLabel", "setEdgeColor",
+			"setEdgeDashed", "setVertexColor", "setVertexSize", "setVertexIcon",
+			"setEdgeThickness", "setEdgeWeight", "setEdgeFlow", "defineEdgeCurved",
+			"defineEdgeColor", "defineEdgeDashed", "defineVertexColor", "defineVertexSize",
+			"defineVertexIcon", "setBackground", "rearrange"
+		};
+		for(size_t i = 0;i < sizeof(names)/sizeof(names[0]);i++)
+			if(name == names[i])
+				return true;
+		return false;
+	}
+
+	static int bucketOf(long long us){
+		int k = 0;
+		while(us > 0 && k + 1 < NUM_BUCKETS){
+			us >>= 1;
+			k++;
+		}
+		return k;
+	}
+
+	static void closeSocket(Socket s){
+#ifdef linux
+		shutdown(s, SHUT_RDWR);
+		close(s);
+#else
+		shutdown(s, SD_BOTH);
+		closesocket(s);
+#endif
+	}
+
+	bool writeAll(const char* data, size_t size){
+#ifdef linux
+		const int flags = MSG_NOSIGNAL;		//a client gone makes send fail instead of raising SIGPIPE
+#else
+		const int flags = 0;
+#endif
+		while(size > 0){
+			int n = ::send(clientSock, data, size, flags);
+			if(n <= 0)
+				return false;
+			data += n;
+			size -= n;
+		}
+		return true;
+	}
+
+	/**
+	 * Answers the commands of one client until it closes the connection.
+	 */
+	void serve(){
+		typedef chrono::steady_clock Clock;
+		vector<char> buffer(READ_BUFFER_SIZE);
+		string line, replies;
+		vector<string> names;
+		while(true){
+			int n = recv(clientSock, &buffer[0], buffer.size(), 0);
+			if(n <= 0)
+				break;
+			Clock::time_point readTime = Clock::now();
+			names.clear();
+			replies.clear();
+			for(int i = 0;i < n;i++){
+				if(buffer[i] != '\n'){
+					line += buffer[i];
+					continue;
+				}
+				if(!line.empty() && line[line.size()-1] == '\r')
+					line.erase(line.size()-1);
+				string name = line.substr(0, line.find(' '));
+				bool known = isCommand(name);
+				names.push_back(known ? name : "unknown");
+				replies += known ? "ok\n" : "error\n";
+				line.clear();
+				if(delayUs > 0)
+					this_thread::sleep_for(chrono::microseconds(delayUs));
+			}
+			if(!replies.empty() && !writeAll(replies.data(), replies.size()))
+				break;
+			long long us = chrono::duration_cast<chrono::microseconds>(Clock::now() - readTime).count();
+			lock_guard<mutex> lock(statsMutex);
+			bytes += n;
+			for(size_t i = 0;i < names.size();i++){
+				CommandStats& s = stats[names[i]];
+				s.count++;
+				s.histogram[bucketOf(us)]++;
+			}
+		}
+	}
+
+	void run(){
+		while(true){
+			Socket s = accept(listenSock, NULL, NULL);
+#ifdef linux
+			if(s < 0)
+				return;
+#else
+			if(s == INVALID_SOCKET)
+				return;
+#endif
+			{
+				lock_guard<mutex> lock(statsMutex);
+				clientSock = s;
+				clientOpen = true;
+				connections++;
+			}
+			serve();
+			lock_guard<mutex> lock(statsMutex);
+			if(clientOpen)
+				closeSocket(clientSock);
+			clientOpen = false;
+			finished++;
+			clientDone.notify_all();
+		}
+	}
+
+	ViewerStub(const ViewerStub&);
+	ViewerStub& operator=(const ViewerStub&);
+
+public:
+	ViewerStub(short port, int delayUs = 0): port(port), delayUs(delayUs), listenSock(0), clientSock(0),
+			clientOpen(false), connections(0), finished(0), bytes(0) {}
+
+	virtual ~ViewerStub(){
+		stop();
+	}
+
+	/**
+	 * Starts listening on localhost. False if the port could not be bound.
+	 */
+	bool start(){
+#ifndef linux
+		WSADATA wsaData;
+		if(WSAStartup(MAKEWORD(2,2), &wsaData) != NO_ERROR)
+			return false;
+#endif
+		listenSock = socket(AF_INET, SOCK_STREAM, 0);
+		int on = 1;
+		setsockopt(listenSock, SOL_SOCKET, SO_REUSEADDR, (const char*) &on, sizeof(on));
+		struct sockaddr_in addr;
+		memset(&addr, 0, sizeof(addr));
+		addr.sin_family = AF_INET;
+		addr.sin_port = htons(port);
+		addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		if(bind(listenSock, (struct sockaddr*) &addr, sizeof(addr)) != 0 || listen(listenSock, 4) != 0){
+			closeSocket(listenSock);
+			return false;
+		}
+		server = thread(&ViewerStub::run, this);
+		return true;
+	}
+
+	/**
+	 * Stops listening and drops the client being served, if any.
+	 */
+	void stop(){
+		if(!server.joinable())
+			return;
+		closeSocket(listenSock);
+		{
+			lock_guard<mutex> lock(statsMutex);
+			if(clientOpen)
+#ifdef linux
+				shutdown(clientSock, SHUT_RDWR);
+#else
+				shutdown(clientSock, SD_BOTH);
+#endif
+		}
+		server.join();
+	}
+
+	/**
+	 * Waits until more than count clients have disconnected and returns how
+	 * many have.
+	 */
+	long long waitFinished(long long count){
+		unique_lock<mutex> lock(statsMutex);
+		while(finished <= count)
+			clientDone.wait(lock);
+		return finished;
+	}
+
+	void resetStats(){
+		lock_guard<mutex> lock(statsMutex);
+		stats.clear();
+		bytes = 0;
+	}
+
+	long long getCount(){
+		lock_guard<mutex> lock(statsMutex);
+		long long res = 0;
+		for(map<string, CommandStats>::const_iterator it = stats.begin();it != stats.end();it++)
+			res += it->second.count;
+		return res;
+	}
+
+	/**
+	 * Counts and histograms as a JSON object, trailing empty buckets left out.
+	 */
+	void writeStats(JsonWriter& w){
+		lock_guard<mutex> lock(statsMutex);
+		w.beginObject();
+		w.key("connections"); w.value(connections);
+		w.key("bytes"); w.value(bytes);
+		w.key("commands");
+		w.beginObject();
+		for(map<string, CommandStats>::const_iterator it = stats.begin();it != stats.end();it++){
+			const CommandStats& s = it->second;
+			int last = NUM_BUCKETS;
+			while(last > 0 && s.histogram[last-1] == 0)
+				last--;
+			w.key(it->first);
+			w.beginObject();
+			w.key("count"); w.value(s.count);
+			w.key("latency_us_log2_histogram");
+			w.beginArray();
+			for(int k = 0;k < last;k++)
+				w.value(s.histogram[k]);
+			w.endArray();
+			w.endObject();
+		}
+		w.endObject();
+		w.endObject();
+	}
+};
+
+#endif /* TOOLS_VIEWERSTUB_H_ */